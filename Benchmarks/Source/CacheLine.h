@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef>
+
+namespace cache_line
+{
+    // for keeping state written by different threads off each other's
+    // cache lines. apple silicon moves 128 byte lines between cores
+   #if defined (__APPLE__) && defined (__aarch64__)
+    constexpr std::size_t size = 128;
+   #else
+    constexpr std::size_t size = 64;
+   #endif
+}
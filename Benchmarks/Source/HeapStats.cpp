@@ -0,0 +1,110 @@
+#include "HeapStats.h"
+#include "RealtimeGuard.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if JUCE_MAC
+ #include <malloc/malloc.h>
+#elif JUCE_LINUX
+ #include <malloc.h>
+#endif
+
+namespace
+{
+    std::atomic<size_t> numAllocations { 0 };
+
+    // with libc interposed, malloc/free count and report this themselves
+    void countAllocation() noexcept
+    {
+       #if ! REALTIME_GUARD_INTERPOSES_LIBC
+        heap_stats::recordAllocation();
+       #endif
+    }
+
+    void checkRealtime (const char* what) noexcept
+    {
+       #if ! REALTIME_GUARD_INTERPOSES_LIBC
+        if (realtime_guard::isInRealtimeSection())
+            realtime_guard::reportViolation(what);
+       #else
+        juce::ignoreUnused(what);
+       #endif
+    }
+
+    void release (void* p) noexcept
+    {
+        if (p != nullptr)
+            checkRealtime("operator delete");
+
+        std::free(p);
+    }
+
+    void* allocate (std::size_t size)
+    {
+        checkRealtime("operator new");
+        countAllocation();
+
+        if (auto* p = std::malloc(size == 0 ? 1 : size))
+            return p;
+
+        throw std::bad_alloc();
+    }
+
+    void* allocateAligned (std::size_t size, std::align_val_t alignment)
+    {
+        checkRealtime("operator new");
+        countAllocation();
+
+        void* p = nullptr;
+        auto align = juce::jmax(sizeof(void*), (size_t)alignment);
+
+        if (posix_memalign(&p, align, size == 0 ? 1 : size) == 0)
+            return p;
+
+        throw std::bad_alloc();
+    }
+}
+
+size_t heap_stats::getBytesInUse()
+{
+   #if JUCE_MAC
+    malloc_statistics_t stats {};
+    malloc_zone_statistics(nullptr, &stats);
+    return stats.size_in_use;
+   #elif JUCE_LINUX && defined(__GLIBC__) && __GLIBC_PREREQ(2, 33)
+    return mallinfo2().uordblks;
+   #else
+    return 0;
+   #endif
+}
+
+size_t heap_stats::getNumAllocations()
+{
+    return numAllocations.load(std::memory_order_relaxed);
+}
+
+const char* heap_stats::getAllocationsLabel()
+{
+    return REALTIME_GUARD_INTERPOSES_LIBC ? "allocations" : "operator new calls";
+}
+
+void heap_stats::recordAllocation() noexcept
+{
+    numAllocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+// replacement global allocation functions, so every c++ allocation is counted
+void* operator new   (std::size_t size) { return allocate(size); }
+void* operator new[] (std::size_t size) { return allocate(size); }
+void* operator new   (std::size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+void* operator new[] (std::size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+
+void operator delete   (void* p) noexcept { release(p); }
+void operator delete[] (void* p) noexcept { release(p); }
+void operator delete   (void* p, std::size_t) noexcept { release(p); }
+void operator delete[] (void* p, std::size_t) noexcept { release(p); }
+void operator delete   (void* p, std::align_val_t) noexcept { release(p); }
+void operator delete[] (void* p, std::align_val_t) noexcept { release(p); }
+void operator delete   (void* p, std::size_t, std::align_val_t) noexcept { release(p); }
+void operator delete[] (void* p, std::size_t, std::align_val_t) noexcept { release(p); }
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// process wide heap counters for the benchmark host
+namespace heap_stats
+{
+    // bytes currently handed out by the system allocator (0 if unsupported)
+    size_t getBytesInUse();
+
+    // number of allocations so far, from any thread. with libc interposed
+    // (see RealtimeGuard.h) that's every malloc-family call, which includes
+    // juce's HeapBlock / AudioBuffer storage, otherwise only operator new calls
+    size_t getNumAllocations();
+
+    // what getNumAllocations() counts, for reports
+    const char* getAllocationsLabel();
+
+    // called by the allocation hooks
+    void recordAllocation() noexcept;
+}
@@ -0,0 +1,57 @@
+#include <JuceHeader.h>
+#include "RealtimeCheck.h"
+#include "RegressionGate.h"
+#include "StressBenchmark.h"
+
+int main (int argc, char* argv[])
+{
+    // the processors' parameter state wants a message manager around
+    juce::ScopedJuceInitialiser_GUI libraryInitialiser;
+
+    juce::ConsoleApplication app;
+    app.addHelpCommand("--help|-h", "TrebleMaker headless benchmark host", true);
+
+    app.addDefaultCommand({ "--stress",
+                            "--stress [--instances=1,10,100,1000] [--threads=1,2,4,8] [--rate=48000] [--block=256] [--blocks=500]",
+                            "Multi-instance scaling and contention benchmark",
+                            "Creates N processors, spreads their processBlock calls round robin over each thread count "
+                            "and reports aggregate throughput, per-instance memory and per-block tail latency.",
+                            [] (const juce::ArgumentList& args)
+                            {
+                                StressBenchmark bench(StressBenchmark::parseOptions(args));
+
+                                if (!bench.run())
+                                    juce::ConsoleApplication::fail("nothing to run");
+                            } });
+
+    app.addCommand({ "--rt-check",
+                     "--rt-check [--rate=48000] [--block=512] [--blocks=2000]",
+                     "Fails if processBlock allocates, locks or blocks",
+                     "Runs processBlock under a headless host with allocation, lock and blocking syscall "
+                     "interposers armed, prints a stack trace for every violation and exits with an error if there were any.",
+                     [] (const juce::ArgumentList& args)
+                     {
+                         RealtimeCheck check(RealtimeCheck::parseOptions(args));
+
+                         if (check.run() > 0)
+                             juce::ConsoleApplication::fail("processBlock is not real-time safe", 1);
+                     } });
+
+    app.addCommand({ "--regress",
+                     "--regress --baseline=path/to/baseline.json [--update-baseline] [--repeats=5]",
+                     "Compares the plugin against the frozen reference, for sound and speed",
+                     "Renders sweeps, noise, impulses and silence under several parameter trajectories through the frozen "
+                     "scalar reference and the current processBlock. Fails if the outputs differ by more than the allowed "
+                     "sample error or null depth, if the engine's ns/sample is slower than the reference's in the same run, "
+                     "or if processBlock's is slower than the stored baseline, beyond the baseline's tolerance. A missing or "
+                     "empty baseline is a failure, --update-baseline records one.",
+                     [] (const juce::ArgumentList& args)
+                     {
+                         RegressionGate gate(RegressionGate::parseOptions(args));
+
+                         if (!gate.run())
+                             juce::ConsoleApplication::fail("regression gate failed", 1);
+                     } });
+
+    return app.findAndRunCommand(argc, argv);
+}
@@ -0,0 +1,81 @@
+#include "RealtimeCheck.h"
+#include "RealtimeGuard.h"
+#include "../../Source/Core/PluginProcessor.h"
+#include <cstdio>
+
+RealtimeCheck::Options RealtimeCheck::parseOptions (const juce::ArgumentList& args)
+{
+    Options o;
+
+    if (args.containsOption("--rate"))   o.sampleRate = juce::jmax(8000.0, args.getValueForOption("--rate").getDoubleValue());
+    if (args.containsOption("--block"))  o.blockSize  = juce::jmax(1, args.getValueForOption("--block").getIntValue());
+    if (args.containsOption("--blocks")) o.numBlocks  = juce::jmax(1, args.getValueForOption("--blocks").getIntValue());
+
+    return o;
+}
+
+RealtimeCheck::RealtimeCheck (Options o)
+    : options(std::move(o))
+{
+}
+
+int RealtimeCheck::run()
+{
+    std::printf("TrebleMaker real-time safety check: %.0f Hz, up to %d samples/block, %d blocks (%s)\n",
+                options.sampleRate, options.blockSize, options.numBlocks,
+                REALTIME_GUARD_INTERPOSES_LIBC ? "new/delete, malloc, locks, waits, sleeps and io"
+                                               : "new/delete only on this platform");
+
+    TrebleMakerAudioProcessor processor;
+    processor.setPlayConfigDetails(2, 2, options.sampleRate, options.blockSize);
+    processor.prepareToPlay(options.sampleRate, options.blockSize);
+
+    juce::AudioBuffer<float> buffer(2, options.blockSize);
+    juce::MidiBuffer midi;
+    juce::Random random(0x7eb1e);
+
+    auto& params = processor.getParameters();
+
+    realtime_guard::clearViolations();
+
+    for (int b = 0; b < options.numBlocks; ++b)
+    {
+        // host side, outside the audio callback: automation, odd block
+        // sizes and the occasional sample rate change
+        if (b % 32 == 0)
+            for (auto* p : params)
+                p->setValueNotifyingHost(random.nextFloat());
+
+        if (b % 500 == 499)
+        {
+            auto rate = b % 1000 == 999 ? options.sampleRate : options.sampleRate * 2.0;
+            processor.setRateAndBufferSizeDetails(rate, options.blockSize);
+
+            // reconfiguring is held to the same standard, it only resets state
+            realtime_guard::ScopedRealtimeSection reconfigure;
+            processor.prepareToPlay(rate, options.blockSize);
+        }
+
+        auto numSamples = b % 3 == 0 ? options.blockSize : 1 + random.nextInt(options.blockSize);
+        buffer.setSize(2, numSamples, false, false, true);
+
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            for (int s = 0; s < numSamples; ++s)
+                buffer.setSample(ch, s, random.nextFloat() * 2.0f - 1.0f);
+
+        {
+            realtime_guard::ScopedRealtimeSection audioThread;
+            processor.processBlock(buffer, midi);
+        }
+    }
+
+    processor.releaseResources();
+
+    auto numViolations = realtime_guard::getNumViolations();
+
+    if (numViolations > 0)
+        realtime_guard::printViolations();
+
+    std::printf("\n%d violation(s) in %d blocks\n", numViolations, options.numBlocks);
+    return numViolations;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// headless host that runs processBlock inside a real-time section, sweeping
+// parameters, modes and block sizes, and reports anything in there that
+// allocates, locks or blocks
+class RealtimeCheck
+{
+public:
+    struct Options
+    {
+        double sampleRate = 48000.0;
+        int    blockSize  = 512;
+        int    numBlocks  = 2000;
+    };
+
+    static Options parseOptions (const juce::ArgumentList& args);
+
+    explicit RealtimeCheck (Options);
+
+    // returns the number of violations found
+    int run();
+
+private:
+    Options options;
+};
@@ -0,0 +1,676 @@
+#include "RealtimeGuard.h"
+#include "HeapStats.h"
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <execinfo.h>
+
+#if REALTIME_GUARD_INTERPOSES_LIBC
+ #include <dlfcn.h>
+ #include <fcntl.h>
+ #include <poll.h>
+ #include <pthread.h>
+ #include <semaphore.h>
+ #include <sys/select.h>
+ #include <time.h>
+ #include <unistd.h>
+#endif
+
+#if REALTIME_GUARD_INTERPOSES_LIBC && JUCE_LINUX
+ #include <linux/futex.h>
+ #include <malloc.h>
+ #include <sys/syscall.h>
+#elif REALTIME_GUARD_INTERPOSES_LIBC && JUCE_MAC
+ #include <condition_variable>
+ #include <mach-o/dyld.h>
+ #include <mach/mach.h>
+ #include <malloc/malloc.h>
+ #include <mutex>
+ #include <os/lock.h>
+#endif
+
+namespace
+{
+   #if JUCE_MAC
+    // darwin's thread_local allocates on a thread's first access, which would
+    // recurse into the malloc zone hooks, so the flags live in pthread keys
+    struct ThreadFlags
+    {
+        ThreadFlags()
+        {
+            pthread_key_create(&depthKey, nullptr);
+            pthread_key_create(&reportingKey, nullptr);
+        }
+
+        pthread_key_t depthKey {}, reportingKey {};
+    } threadFlags;
+
+    int  getDepth() noexcept              { return (int)(intptr_t)pthread_getspecific(threadFlags.depthKey); }
+    void setDepth (int depth) noexcept    { pthread_setspecific(threadFlags.depthKey, (void*)(intptr_t)depth); }
+    bool isReporting() noexcept           { return pthread_getspecific(threadFlags.reportingKey) != nullptr; }
+    void setReporting (bool b) noexcept   { pthread_setspecific(threadFlags.reportingKey, b ? &threadFlags : nullptr); }
+   #else
+    // plain tls, no constructor, so it's usable from inside malloc
+    thread_local int realtimeDepth = 0;
+    thread_local bool reporting = false;
+
+    int  getDepth() noexcept              { return realtimeDepth; }
+    void setDepth (int depth) noexcept    { realtimeDepth = depth; }
+    bool isReporting() noexcept           { return reporting; }
+    void setReporting (bool b) noexcept   { reporting = b; }
+   #endif
+
+    struct Violation
+    {
+        const char* what = nullptr;
+        std::array<void*, 48> frames {};
+        int numFrames = 0;
+    };
+
+    // fixed size so recording never allocates
+    constexpr int maxRecorded = 32;
+    std::array<Violation, maxRecorded> violations;
+    std::atomic<int> numViolations { 0 };
+
+    struct BacktracePrimer
+    {
+        // the first backtrace() call loads the unwinder (and allocates), get that out of the way
+        BacktracePrimer() { void* frames[4]; backtrace(frames, 4); }
+    } backtracePrimer;
+}
+
+realtime_guard::ScopedRealtimeSection::ScopedRealtimeSection() noexcept  { setDepth(getDepth() + 1); }
+realtime_guard::ScopedRealtimeSection::~ScopedRealtimeSection() noexcept { setDepth(getDepth() - 1); }
+
+bool realtime_guard::isInRealtimeSection() noexcept
+{
+    return getDepth() > 0 && !isReporting();
+}
+
+void realtime_guard::reportViolation (const char* what) noexcept
+{
+    setReporting(true);
+
+    auto index = numViolations.fetch_add(1);
+
+    if (index < maxRecorded)
+    {
+        auto& v = violations[(size_t)index];
+        v.what = what;
+        v.numFrames = backtrace(v.frames.data(), (int)v.frames.size());
+    }
+
+    setReporting(false);
+}
+
+int realtime_guard::getNumViolations() noexcept
+{
+    return numViolations.load();
+}
+
+void realtime_guard::clearViolations() noexcept
+{
+    numViolations.store(0);
+}
+
+void realtime_guard::printViolations()
+{
+    auto count = getNumViolations();
+
+    for (int i = 0; i < juce::jmin(count, maxRecorded); ++i)
+    {
+        auto& v = violations[(size_t)i];
+        std::printf("\nviolation %d: %s on the audio thread\n", i + 1, v.what);
+        std::fflush(stdout);
+
+        // skip our own reporting frames
+        backtrace_symbols_fd(v.frames.data() + 1, v.numFrames - 1, fileno(stdout));
+    }
+
+    if (count > maxRecorded)
+        std::printf("\n... and %d more\n", count - maxRecorded);
+}
+
+#if REALTIME_GUARD_INTERPOSES_LIBC
+
+namespace
+{
+    void check (const char* what) noexcept
+    {
+        if (realtime_guard::isInRealtimeSection())
+            realtime_guard::reportViolation(what);
+    }
+
+    // allocation hooks also feed the benchmark's allocation count
+    void checkAllocation (const char* what) noexcept
+    {
+        heap_stats::recordAllocation();
+        check(what);
+    }
+
+    // open only has a mode argument when it may create the file
+    bool hasModeArgument (int flags) noexcept
+    {
+       #ifdef O_TMPFILE
+        if ((flags & O_TMPFILE) == O_TMPFILE)
+            return true;
+       #endif
+
+        return (flags & O_CREAT) != 0;
+    }
+}
+
+#endif
+
+#if REALTIME_GUARD_INTERPOSES_LIBC && JUCE_LINUX
+
+// definitions in the executable take precedence over libc's for every
+// module in the process. allocation goes straight to glibc's internal
+// entry points, everything else to the next definition found by dlsym
+extern "C"
+{
+    void* __libc_malloc (size_t);
+    void* __libc_calloc (size_t, size_t);
+    void* __libc_realloc (void*, size_t);
+    void* __libc_memalign (size_t, size_t);
+    void* __libc_valloc (size_t);
+    void* __libc_pvalloc (size_t);
+    void  __libc_free (void*);
+}
+
+namespace
+{
+    template <typename Fn>
+    Fn next (Fn& cached, const char* name) noexcept
+    {
+        if (cached == nullptr)
+            cached = reinterpret_cast<Fn> (dlsym(RTLD_NEXT, name));
+
+        return cached;
+    }
+
+    // only the waiting futex operations, wakes don't block
+    bool isFutexWait (long op) noexcept
+    {
+        switch (op & FUTEX_CMD_MASK)
+        {
+            case FUTEX_WAIT:
+            case FUTEX_WAIT_BITSET:
+            case FUTEX_LOCK_PI:
+            case FUTEX_WAIT_REQUEUE_PI:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    int (*realMutexLock) (pthread_mutex_t*) = nullptr;
+    int (*realMutexTrylock) (pthread_mutex_t*) = nullptr;
+    int (*realMutexTimedlock) (pthread_mutex_t*, const timespec*) = nullptr;
+    int (*realSpinLock) (pthread_spinlock_t*) = nullptr;
+    int (*realRwlockRdlock) (pthread_rwlock_t*) = nullptr;
+    int (*realRwlockWrlock) (pthread_rwlock_t*) = nullptr;
+    int (*realRwlockTimedrdlock) (pthread_rwlock_t*, const timespec*) = nullptr;
+    int (*realRwlockTimedwrlock) (pthread_rwlock_t*, const timespec*) = nullptr;
+    int (*realCondWait) (pthread_cond_t*, pthread_mutex_t*) = nullptr;
+    int (*realCondTimedwait) (pthread_cond_t*, pthread_mutex_t*, const timespec*) = nullptr;
+    int (*realCondClockwait) (pthread_cond_t*, pthread_mutex_t*, clockid_t, const timespec*) = nullptr;
+    int (*realSemWait) (sem_t*) = nullptr;
+    int (*realSemTimedwait) (sem_t*, const timespec*) = nullptr;
+    int (*realNanosleep) (const timespec*, timespec*) = nullptr;
+    int (*realClockNanosleep) (clockid_t, int, const timespec*, timespec*) = nullptr;
+    int (*realUsleep) (useconds_t) = nullptr;
+    ssize_t (*realRead) (int, void*, size_t) = nullptr;
+    ssize_t (*realWrite) (int, const void*, size_t) = nullptr;
+    int (*realOpen) (const char*, int, ...) = nullptr;
+    int (*realOpen64) (const char*, int, ...) = nullptr;
+    int (*realFsync) (int) = nullptr;
+    int (*realPoll) (pollfd*, nfds_t, int) = nullptr;
+    int (*realSelect) (int, fd_set*, fd_set*, fd_set*, timeval*) = nullptr;
+    long (*realSyscall) (long, ...) = nullptr;
+
+    // resolve everything up front, dlsym itself isn't something to run on the audio thread
+    struct Resolver
+    {
+        Resolver()
+        {
+            next(realMutexLock, "pthread_mutex_lock");
+            next(realMutexTrylock, "pthread_mutex_trylock");
+            next(realMutexTimedlock, "pthread_mutex_timedlock");
+            next(realSpinLock, "pthread_spin_lock");
+            next(realRwlockRdlock, "pthread_rwlock_rdlock");
+            next(realRwlockWrlock, "pthread_rwlock_wrlock");
+            next(realRwlockTimedrdlock, "pthread_rwlock_timedrdlock");
+            next(realRwlockTimedwrlock, "pthread_rwlock_timedwrlock");
+            next(realCondWait, "pthread_cond_wait");
+            next(realCondTimedwait, "pthread_cond_timedwait");
+            next(realCondClockwait, "pthread_cond_clockwait");
+            next(realSemWait, "sem_wait");
+            next(realSemTimedwait, "sem_timedwait");
+            next(realNanosleep, "nanosleep");
+            next(realClockNanosleep, "clock_nanosleep");
+            next(realUsleep, "usleep");
+            next(realRead, "read");
+            next(realWrite, "write");
+            next(realOpen, "open");
+            next(realOpen64, "open64");
+            next(realFsync, "fsync");
+            next(realPoll, "poll");
+            next(realSelect, "select");
+            next(realSyscall, "syscall");
+        }
+    } resolver;
+}
+
+extern "C"
+{
+    void* malloc (size_t size) noexcept                       { checkAllocation("malloc");  return __libc_malloc(size); }
+    void* calloc (size_t n, size_t size) noexcept             { checkAllocation("calloc");  return __libc_calloc(n, size); }
+    void* realloc (void* p, size_t size) noexcept             { checkAllocation("realloc"); return __libc_realloc(p, size); }
+    void  free (void* p) noexcept                             { if (p != nullptr) check("free"); __libc_free(p); }
+    void* memalign (size_t align, size_t size) noexcept       { checkAllocation("memalign"); return __libc_memalign(align, size); }
+    void* aligned_alloc (size_t align, size_t size) noexcept  { checkAllocation("aligned_alloc"); return __libc_memalign(align, size); }
+    void* valloc (size_t size) noexcept                       { checkAllocation("valloc");  return __libc_valloc(size); }
+    void* pvalloc (size_t size) noexcept                      { checkAllocation("pvalloc"); return __libc_pvalloc(size); }
+
+    void* reallocarray (void* p, size_t n, size_t size) noexcept
+    {
+        checkAllocation("reallocarray");
+
+        size_t total;
+
+        if (__builtin_mul_overflow(n, size, &total))
+        {
+            errno = ENOMEM;
+            return nullptr;
+        }
+
+        return __libc_realloc(p, total);
+    }
+
+    int posix_memalign (void** result, size_t align, size_t size) noexcept
+    {
+        checkAllocation("posix_memalign");
+
+        if (align < sizeof(void*) || (align & (align - 1)) != 0)
+            return EINVAL;
+
+        *result = __libc_memalign(align, size);
+        return *result != nullptr ? 0 : ENOMEM;
+    }
+
+    int pthread_mutex_lock (pthread_mutex_t* m) noexcept     { check("pthread_mutex_lock");  return next(realMutexLock, "pthread_mutex_lock")(m); }
+    int pthread_mutex_trylock (pthread_mutex_t* m) noexcept  { check("pthread_mutex_trylock"); return next(realMutexTrylock, "pthread_mutex_trylock")(m); }
+    int pthread_spin_lock (pthread_spinlock_t* l) noexcept   { check("pthread_spin_lock");  return next(realSpinLock, "pthread_spin_lock")(l); }
+    int pthread_rwlock_rdlock (pthread_rwlock_t* l) noexcept { check("pthread_rwlock_rdlock"); return next(realRwlockRdlock, "pthread_rwlock_rdlock")(l); }
+    int pthread_rwlock_wrlock (pthread_rwlock_t* l) noexcept { check("pthread_rwlock_wrlock"); return next(realRwlockWrlock, "pthread_rwlock_wrlock")(l); }
+
+    int pthread_mutex_timedlock (pthread_mutex_t* m, const timespec* t) noexcept
+    {
+        check("pthread_mutex_timedlock");
+        return next(realMutexTimedlock, "pthread_mutex_timedlock")(m, t);
+    }
+
+    int pthread_rwlock_timedrdlock (pthread_rwlock_t* l, const timespec* t) noexcept
+    {
+        check("pthread_rwlock_timedrdlock");
+        return next(realRwlockTimedrdlock, "pthread_rwlock_timedrdlock")(l, t);
+    }
+
+    int pthread_rwlock_timedwrlock (pthread_rwlock_t* l, const timespec* t) noexcept
+    {
+        check("pthread_rwlock_timedwrlock");
+        return next(realRwlockTimedwrlock, "pthread_rwlock_timedwrlock")(l, t);
+    }
+
+    int pthread_cond_wait (pthread_cond_t* c, pthread_mutex_t* m)
+    {
+        check("pthread_cond_wait");
+        return next(realCondWait, "pthread_cond_wait")(c, m);
+    }
+
+    int pthread_cond_timedwait (pthread_cond_t* c, pthread_mutex_t* m, const timespec* t)
+    {
+        check("pthread_cond_timedwait");
+        return next(realCondTimedwait, "pthread_cond_timedwait")(c, m, t);
+    }
+
+   #if __GLIBC_PREREQ(2, 30)
+    int pthread_cond_clockwait (pthread_cond_t* c, pthread_mutex_t* m, clockid_t clock, const timespec* t)
+    {
+        check("pthread_cond_clockwait");
+        return next(realCondClockwait, "pthread_cond_clockwait")(c, m, clock, t);
+    }
+   #endif
+
+    int sem_wait (sem_t* s)                                 { check("sem_wait");  return next(realSemWait, "sem_wait")(s); }
+    int sem_timedwait (sem_t* s, const timespec* t)         { check("sem_timedwait"); return next(realSemTimedwait, "sem_timedwait")(s, t); }
+    int nanosleep (const timespec* t, timespec* r)          { check("nanosleep"); return next(realNanosleep, "nanosleep")(t, r); }
+    int usleep (useconds_t us)                              { check("usleep");    return next(realUsleep, "usleep")(us); }
+    ssize_t read (int fd, void* buf, size_t n)              { check("read");      return next(realRead, "read")(fd, buf, n); }
+    ssize_t write (int fd, const void* buf, size_t n)       { check("write");     return next(realWrite, "write")(fd, buf, n); }
+    int fsync (int fd)                                      { check("fsync");     return next(realFsync, "fsync")(fd); }
+    int poll (pollfd* fds, nfds_t n, int timeout)           { check("poll");      return next(realPoll, "poll")(fds, n, timeout); }
+
+    int open (const char* path, int flags, ...)
+    {
+        va_list args;
+        va_start (args, flags);
+        auto mode = hasModeArgument(flags) ? (mode_t)va_arg (args, int) : (mode_t)0;
+        va_end (args);
+
+        check("open");
+        return next(realOpen, "open")(path, flags, mode);
+    }
+
+    int open64 (const char* path, int flags, ...)
+    {
+        va_list args;
+        va_start (args, flags);
+        auto mode = hasModeArgument(flags) ? (mode_t)va_arg (args, int) : (mode_t)0;
+        va_end (args);
+
+        check("open64");
+        return next(realOpen64, "open64")(path, flags, mode);
+    }
+
+    int clock_nanosleep (clockid_t clock, int flags, const timespec* t, timespec* r)
+    {
+        check("clock_nanosleep");
+        return next(realClockNanosleep, "clock_nanosleep")(clock, flags, t, r);
+    }
+
+    int select (int n, fd_set* r, fd_set* w, fd_set* e, timeval* t)
+    {
+        check("select");
+        return next(realSelect, "select")(n, r, w, e, t);
+    }
+
+    // catches futex waits made through syscall(), e.g. by hand-rolled locks.
+    // no syscall takes more than six arguments, so all six are forwarded
+    long syscall (long number, ...) noexcept
+    {
+        va_list args;
+        va_start (args, number);
+
+        long a[6];
+
+        for (auto& arg : a)
+            arg = va_arg (args, long);
+
+        va_end (args);
+
+        if (number == SYS_futex && isFutexWait(a[1]))
+            check("futex wait");
+
+        return next(realSyscall, "syscall")(number, a[0], a[1], a[2], a[3], a[4], a[5]);
+    }
+}
+
+#elif REALTIME_GUARD_INTERPOSES_LIBC && JUCE_MAC
+
+// dyld doesn't apply DYLD_INTERPOSE tuples from the main executable (only
+// from dylibs), so locks, waits, sleeps and io are rebound at startup with
+// dyld_dynamic_interpose, in every image as it gets loaded. images in the
+// shared cache (libc++, libsystem) can't be rebound, so calls they make
+// internally aren't seen. juce and the plugin are compiled into the
+// executable, which is what matters here.
+//
+// allocation doesn't depend on any of that: the functions of every malloc
+// zone are wrapped, which catches heap calls from all modules.
+extern "C"
+{
+    // private, exported by libdyld (mach-o/dyld_priv.h)
+    struct dyld_interpose_tuple
+    {
+        const void* replacement;
+        const void* replacee;
+    };
+
+    void dyld_dynamic_interpose (const mach_header*, const dyld_interpose_tuple[], size_t);
+}
+
+namespace
+{
+    // what each wrapped zone did before
+    struct ZoneFunctions
+    {
+        malloc_zone_t* zone = nullptr;
+        void* (*malloc) (malloc_zone_t*, size_t) = nullptr;
+        void* (*calloc) (malloc_zone_t*, size_t, size_t) = nullptr;
+        void* (*valloc) (malloc_zone_t*, size_t) = nullptr;
+        void* (*realloc) (malloc_zone_t*, void*, size_t) = nullptr;
+        void* (*memalign) (malloc_zone_t*, size_t, size_t) = nullptr;
+        void  (*free) (malloc_zone_t*, void*) = nullptr;
+        void  (*freeDefiniteSize) (malloc_zone_t*, void*, size_t) = nullptr;
+    };
+
+    constexpr int maxZones = 16;
+    std::array<ZoneFunctions, maxZones> zones;
+    int numZones = 0;
+
+    const ZoneFunctions& original (malloc_zone_t* zone) noexcept
+    {
+        for (int i = 0; i < numZones; ++i)
+            if (zones[(size_t)i].zone == zone)
+                return zones[(size_t)i];
+
+        return zones[0]; // never reached, only wrapped zones call in here
+    }
+
+    void* zoneMalloc (malloc_zone_t* zone, size_t size)
+    {
+        checkAllocation("malloc");
+        return original(zone).malloc(zone, size);
+    }
+
+    void* zoneCalloc (malloc_zone_t* zone, size_t n, size_t size)
+    {
+        checkAllocation("calloc");
+        return original(zone).calloc(zone, n, size);
+    }
+
+    void* zoneValloc (malloc_zone_t* zone, size_t size)
+    {
+        checkAllocation("valloc");
+        return original(zone).valloc(zone, size);
+    }
+
+    void* zoneRealloc (malloc_zone_t* zone, void* p, size_t size)
+    {
+        checkAllocation("realloc");
+        return original(zone).realloc(zone, p, size);
+    }
+
+    void* zoneMemalign (malloc_zone_t* zone, size_t align, size_t size)
+    {
+        checkAllocation("memalign");
+        return original(zone).memalign(zone, align, size);
+    }
+
+    void zoneFree (malloc_zone_t* zone, void* p)
+    {
+        if (p != nullptr)
+            check("free");
+
+        original(zone).free(zone, p);
+    }
+
+    void zoneFreeDefiniteSize (malloc_zone_t* zone, void* p, size_t size)
+    {
+        check("free");
+        original(zone).freeDefiniteSize(zone, p, size);
+    }
+
+    void wrapZone (malloc_zone_t* zone)
+    {
+        if (zone == nullptr || numZones == maxZones)
+            return;
+
+        for (int i = 0; i < numZones; ++i)
+            if (zones[(size_t)i].zone == zone)
+                return;
+
+        auto& f = zones[(size_t)numZones];
+        f.zone             = zone;
+        f.malloc           = zone->malloc;
+        f.calloc           = zone->calloc;
+        f.valloc           = zone->valloc;
+        f.realloc          = zone->realloc;
+        f.free             = zone->free;
+        f.memalign         = zone->version >= 5 ? zone->memalign : nullptr;
+        f.freeDefiniteSize = zone->version >= 6 ? zone->free_definite_size : nullptr;
+        ++numZones;
+
+        // newer zones live on a read-only page
+        auto isProtected = zone->version >= 8;
+
+        if (isProtected)
+            vm_protect(mach_task_self(), (vm_address_t)zone, sizeof(malloc_zone_t), false, VM_PROT_READ | VM_PROT_WRITE);
+
+        zone->malloc  = zoneMalloc;
+        zone->calloc  = zoneCalloc;
+        zone->valloc  = zoneValloc;
+        zone->realloc = zoneRealloc;
+        zone->free    = zoneFree;
+
+        if (f.memalign != nullptr)
+            zone->memalign = zoneMemalign;
+
+        if (f.freeDefiniteSize != nullptr)
+            zone->free_definite_size = zoneFreeDefiniteSize;
+
+        if (isProtected)
+            vm_protect(mach_task_self(), (vm_address_t)zone, sizeof(malloc_zone_t), false, VM_PROT_READ);
+    }
+
+    int (*realMutexLock) (pthread_mutex_t*) = nullptr;
+    int (*realMutexTrylock) (pthread_mutex_t*) = nullptr;
+    int (*realRwlockRdlock) (pthread_rwlock_t*) = nullptr;
+    int (*realRwlockWrlock) (pthread_rwlock_t*) = nullptr;
+    int (*realCondWait) (pthread_cond_t*, pthread_mutex_t*) = nullptr;
+    int (*realCondTimedwait) (pthread_cond_t*, pthread_mutex_t*, const timespec*) = nullptr;
+    void (*realUnfairLock) (os_unfair_lock_t) = nullptr;
+    void (*realStdMutexLock) (std::mutex*) = nullptr;
+    void (*realStdCondWait) (std::condition_variable*, std::unique_lock<std::mutex>*) = nullptr;
+    int (*realSemWait) (sem_t*) = nullptr;
+    int (*realNanosleep) (const timespec*, timespec*) = nullptr;
+    int (*realUsleep) (useconds_t) = nullptr;
+    ssize_t (*realRead) (int, void*, size_t) = nullptr;
+    ssize_t (*realWrite) (int, const void*, size_t) = nullptr;
+    int (*realOpen) (const char*, int, ...) = nullptr;
+    int (*realFsync) (int) = nullptr;
+    int (*realPoll) (pollfd*, nfds_t, int) = nullptr;
+    int (*realSelect) (int, fd_set*, fd_set*, fd_set*, timeval*) = nullptr; // select$DARWIN_EXTSN
+
+    int hookMutexLock (pthread_mutex_t* m)                  { check("pthread_mutex_lock");  return realMutexLock(m); }
+    int hookMutexTrylock (pthread_mutex_t* m)               { check("pthread_mutex_trylock"); return realMutexTrylock(m); }
+    int hookRwlockRdlock (pthread_rwlock_t* l)              { check("pthread_rwlock_rdlock"); return realRwlockRdlock(l); }
+    int hookRwlockWrlock (pthread_rwlock_t* l)              { check("pthread_rwlock_wrlock"); return realRwlockWrlock(l); }
+    void hookUnfairLock (os_unfair_lock_t l)                { check("os_unfair_lock_lock"); realUnfairLock(l); }
+    void hookStdMutexLock (std::mutex* m)                   { check("std::mutex::lock"); realStdMutexLock(m); }
+    int hookSemWait (sem_t* s)                              { check("sem_wait");  return realSemWait(s); }
+    int hookNanosleep (const timespec* t, timespec* r)      { check("nanosleep"); return realNanosleep(t, r); }
+    int hookUsleep (useconds_t us)                          { check("usleep");    return realUsleep(us); }
+    ssize_t hookRead (int fd, void* buf, size_t n)          { check("read");      return realRead(fd, buf, n); }
+    ssize_t hookWrite (int fd, const void* buf, size_t n)   { check("write");     return realWrite(fd, buf, n); }
+    int hookFsync (int fd)                                  { check("fsync");     return realFsync(fd); }
+    int hookPoll (pollfd* fds, nfds_t n, int timeout)       { check("poll");      return realPoll(fds, n, timeout); }
+
+    int hookCondWait (pthread_cond_t* c, pthread_mutex_t* m)
+    {
+        check("pthread_cond_wait");
+        return realCondWait(c, m);
+    }
+
+    int hookCondTimedwait (pthread_cond_t* c, pthread_mutex_t* m, const timespec* t)
+    {
+        check("pthread_cond_timedwait");
+        return realCondTimedwait(c, m, t);
+    }
+
+    void hookStdCondWait (std::condition_variable* c, std::unique_lock<std::mutex>* l)
+    {
+        check("std::condition_variable::wait");
+        realStdCondWait(c, l);
+    }
+
+    int hookOpen (const char* path, int flags, ...)
+    {
+        va_list args;
+        va_start (args, flags);
+        auto mode = hasModeArgument(flags) ? va_arg (args, int) : 0;
+        va_end (args);
+
+        check("open");
+        return realOpen(path, flags, mode);
+    }
+
+    int hookSelect (int n, fd_set* r, fd_set* w, fd_set* e, timeval* t)
+    {
+        check("select");
+        return realSelect(n, r, w, e, t);
+    }
+
+    constexpr int maxTuples = 24;
+    std::array<dyld_interpose_tuple, maxTuples> tuples;
+    size_t numTuples = 0;
+
+    template <typename Fn>
+    void addTuple (Fn& real, Fn hook, const char* name)
+    {
+        // dlsym finds the definition itself, rebinding other images doesn't change it
+        real = reinterpret_cast<Fn> (dlsym(RTLD_DEFAULT, name));
+
+        if (real != nullptr && numTuples < tuples.size())
+            tuples[numTuples++] = { reinterpret_cast<const void*> (hook), reinterpret_cast<const void*> (real) };
+    }
+
+    void interposeImage (const mach_header* header, intptr_t)
+    {
+        constexpr uint32_t dylibInCache = 0x80000000; // MH_DYLIB_IN_CACHE
+
+        if ((header->flags & dylibInCache) == 0)
+            dyld_dynamic_interpose(header, tuples.data(), numTuples);
+    }
+
+    struct Installer
+    {
+        Installer()
+        {
+            vm_address_t* allZones = nullptr;
+            unsigned int count = 0;
+
+            if (malloc_get_all_zones(mach_task_self(), nullptr, &allZones, &count) == KERN_SUCCESS)
+                for (unsigned int i = 0; i < count; ++i)
+                    wrapZone(reinterpret_cast<malloc_zone_t*> (allZones[i]));
+
+            addTuple(realMutexLock, hookMutexLock, "pthread_mutex_lock");
+            addTuple(realMutexTrylock, hookMutexTrylock, "pthread_mutex_trylock");
+            addTuple(realRwlockRdlock, hookRwlockRdlock, "pthread_rwlock_rdlock");
+            addTuple(realRwlockWrlock, hookRwlockWrlock, "pthread_rwlock_wrlock");
+            addTuple(realCondWait, hookCondWait, "pthread_cond_wait");
+            addTuple(realCondTimedwait, hookCondTimedwait, "pthread_cond_timedwait");
+            addTuple(realUnfairLock, hookUnfairLock, "os_unfair_lock_lock");
+            addTuple(realStdMutexLock, hookStdMutexLock, "_ZNSt3__15mutex4lockEv");
+            addTuple(realStdCondWait, hookStdCondWait, "_ZNSt3__118condition_variable4waitERNS_11unique_lockINS_5mutexEEE");
+            addTuple(realSemWait, hookSemWait, "sem_wait");
+            addTuple(realNanosleep, hookNanosleep, "nanosleep");
+            addTuple(realUsleep, hookUsleep, "usleep");
+            addTuple(realRead, hookRead, "read");
+            addTuple(realWrite, hookWrite, "write");
+            addTuple(realOpen, hookOpen, "open");
+            addTuple(realFsync, hookFsync, "fsync");
+            addTuple(realPoll, hookPoll, "poll");
+            addTuple(realSelect, hookSelect, "select$DARWIN_EXTSN");
+
+            // also runs for every image that's already loaded
+            _dyld_register_func_for_add_image(interposeImage);
+        }
+    } installer;
+}
+
+#endif
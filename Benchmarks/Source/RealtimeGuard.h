@@ -0,0 +1,53 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// catches calls that aren't real-time safe (allocation, locking, blocking
+// syscalls) made by a thread while it's inside a ScopedRealtimeSection.
+//
+// global operator new/delete are always checked. beyond that:
+//
+// linux/glibc: the malloc family (malloc, calloc, realloc, reallocarray,
+// memalign, aligned_alloc, posix_memalign, valloc, pvalloc), pthread mutex /
+// spin / rwlock locks (plain, try and timed), condition waits (wait,
+// timedwait, clockwait), semaphore waits, futex waits through syscall(),
+// sleeps, and open / read / write / fsync / poll / select are interposed
+// by defining them in the executable.
+//
+// macOS: every malloc zone is wrapped, so the malloc family is checked for
+// all modules. pthread mutex / rwlock locks, os_unfair_lock, std::mutex,
+// condition and semaphore waits, sleeps, and open / read / write / fsync /
+// poll / select are rebound in every image outside the shared cache, which
+// includes the executable with juce and the plugin in it.
+//
+// not covered: calls the system libraries make internally (glibc, or
+// anything in the macOS shared cache such as libc++) and raw inline
+// syscalls that bypass libc entirely.
+#if (JUCE_LINUX && defined(__GLIBC__)) || JUCE_MAC
+ #define REALTIME_GUARD_INTERPOSES_LIBC 1
+#else
+ #define REALTIME_GUARD_INTERPOSES_LIBC 0
+#endif
+
+namespace realtime_guard
+{
+    // marks the calling thread as the audio thread for its lifetime
+    struct ScopedRealtimeSection
+    {
+        ScopedRealtimeSection() noexcept;
+        ~ScopedRealtimeSection() noexcept;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedRealtimeSection)
+    };
+
+    bool isInRealtimeSection() noexcept;
+
+    // called by the interposed functions, records the call and its stack
+    void reportViolation (const char* what) noexcept;
+
+    int  getNumViolations() noexcept;
+    void clearViolations() noexcept;
+
+    // symbolized stack traces of everything recorded so far
+    void printViolations();
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../Source/Core/TrebleMakerEngine.h"
+
+// frozen copy of TrebleMakerAudioProcessor::processBlock as it was before the
+// dsp moved into treble_dsp::Engine (juce tpt filters, dry buffer, separate
+// mix and saturation passes). it's the scalar reference the regression gate
+// compares the current implementation against, don't optimise it.
+class ReferenceProcessor
+{
+public:
+    void prepare (double newSampleRate, int samplesPerBlock, int numChannels)
+    {
+        sampleRate = newSampleRate;
+
+        juce::dsp::ProcessSpec spec;
+        spec.sampleRate = sampleRate;
+        spec.maximumBlockSize = (juce::uint32)samplesPerBlock;
+        spec.numChannels = (juce::uint32)numChannels;
+
+        filters.clear();
+        for (int i = 0; i < numChannels; ++i)
+        {
+            auto filter = std::make_unique<juce::dsp::StateVariableTPTFilter<float>>();
+            filter->prepare(spec);
+            filter->setType(juce::dsp::StateVariableTPTFilterType::highpass);
+            filters.push_back(std::move(filter));
+        }
+
+        dryBuffer.setSize(numChannels, samplesPerBlock);
+
+        driftPhase = 0.0;
+    }
+
+    void process (juce::AudioBuffer<float>& buffer, const treble_dsp::Parameters& params)
+    {
+        juce::ScopedNoDenormals noDenormals;
+
+        float currentCutoff = params.cutoff;
+        float driveAmount   = params.gain;
+        float currentQ      = params.q;
+        bool isReduceMode   = params.reduceMode;
+
+        // analog drift
+        double driftAmount = std::sin(driftPhase) * 0.005;
+
+        driftPhase += (2.0 * juce::MathConstants<double>::pi * 0.2) / sampleRate * buffer.getNumSamples();
+
+        if (driftPhase > juce::MathConstants<double>::twoPi)
+            driftPhase -= juce::MathConstants<double>::twoPi;
+
+        float analogFreq = currentCutoff * (1.0f + (float)driftAmount);
+
+        // link q to gain
+        float analogQ = currentQ + (driveAmount * 0.02f);
+
+        for (auto& filter : filters)
+        {
+            filter->setCutoffFrequency(analogFreq);
+            filter->setResonance(analogQ);
+        }
+
+        // copy dry
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            dryBuffer.copyFrom(ch, 0, buffer, ch, 0, buffer.getNumSamples());
+
+        // process filters
+        juce::dsp::AudioBlock<float> block(buffer);
+
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            if (ch < (int)filters.size())
+            {
+                auto singleChannelBlock = block.getSingleChannelBlock((size_t)ch);
+                juce::dsp::ProcessContextReplacing<float> context(singleChannelBlock);
+                filters[(size_t)ch]->process(context);
+            }
+        }
+
+        // mix
+        if (!isReduceMode)
+        {
+            // boost
+            float boostAmount = juce::Decibels::decibelsToGain(driveAmount) - 1.0f;
+
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            {
+                buffer.applyGain(ch, 0, buffer.getNumSamples(), boostAmount);
+                buffer.addFrom(ch, 0, dryBuffer, ch, 0, buffer.getNumSamples());
+            }
+        }
+        else
+        {
+            // cut
+            float cutAmount = juce::Decibels::decibelsToGain(driveAmount);
+
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            {
+                buffer.applyGain(ch, 0, buffer.getNumSamples(), cutAmount);
+
+                auto* dryData = dryBuffer.getReadPointer(ch);
+                auto* wetData = buffer.getWritePointer(ch);
+
+                for (int s = 0; s < buffer.getNumSamples(); ++s)
+                    wetData[s] = dryData[s] - wetData[s];
+            }
+        }
+
+        // saturation
+        if (!isReduceMode && driveAmount > 0.1f)
+        {
+            float targetDrive = 1.0f + (driveAmount * 0.08f);
+            smoothDrive = smoothDrive * 0.95f + targetDrive * 0.05f;
+
+            const float dcBias = 0.15f;
+
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            {
+                auto* channelData = buffer.getWritePointer(channel);
+
+                for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+                {
+                    float in = channelData[sample];
+
+                    float x = in * smoothDrive;
+                    x += dcBias;
+
+                    // soft clip tanh
+                    float saturated = std::tanh(x);
+                    float out = saturated - std::tanh(dcBias);
+
+                    out /= (std::tanh(smoothDrive + dcBias) - std::tanh(dcBias));
+
+                    float blend = juce::jmin(driveAmount / 12.0f, 1.0f);
+
+                    channelData[sample] = (out * blend) + (in * (1.0f - blend));
+                }
+            }
+        }
+    }
+
+private:
+    std::vector<std::unique_ptr<juce::dsp::StateVariableTPTFilter<float>>> filters;
+    juce::AudioBuffer<float> dryBuffer;
+
+    double sampleRate = 44100.0;
+    double driftPhase = 0.0;
+    float  smoothDrive = 0.0f;
+};
@@ -0,0 +1,423 @@
+#include "RegressionGate.h"
+#include "ReferenceProcessor.h"
+#include "../../Source/Core/PluginProcessor.h"
+#include <cstdio>
+#include <limits>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int    blockSize  = 512;
+    constexpr int    numChannels = 2;
+    constexpr int    numSamples = 2 * (int)sampleRate;
+
+    // defaults, the baseline file can override them
+    constexpr double defaultTolerance = 0.10;     // allowed ns/sample regression
+    constexpr double defaultMaxError  = 1.0e-5;   // absolute, per sample
+    constexpr double defaultNullDepth = 100.0;    // db below the reference
+
+    struct Signal
+    {
+        const char* name;
+        std::function<float (int sample, int channel)> generate;
+    };
+
+    std::vector<Signal> makeSignals()
+    {
+        auto noise = std::make_shared<juce::AudioBuffer<float>>(numChannels, numSamples);
+        juce::Random random(0x7eb1e);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int s = 0; s < numSamples; ++s)
+                noise->setSample(ch, s, random.nextFloat() * 1.4f - 0.7f);
+
+        return {
+            { "sweep", [] (int s, int ch)
+                {
+                    // log sine sweep 20 Hz - 20 kHz, right channel inverted
+                    auto duration = numSamples / sampleRate;
+                    auto k = std::log(20000.0 / 20.0);
+                    auto t = s / sampleRate;
+                    auto phase = juce::MathConstants<double>::twoPi * 20.0 * duration / k * (std::exp(t / duration * k) - 1.0);
+                    return (float)(std::sin(phase) * (ch == 0 ? 0.5 : -0.5));
+                } },
+            { "noise",    [noise] (int s, int ch) { return noise->getSample(ch, s); } },
+            { "impulses", [] (int s, int ch) { return (s + ch * 7) % 4800 == 0 ? 1.0f : 0.0f; } },
+            { "silence",  [] (int, int) { return 0.0f; } }
+        };
+    }
+
+    struct NamedTrajectory
+    {
+        const char* name;
+        std::function<treble_dsp::Parameters (double)> at;
+    };
+
+    std::vector<NamedTrajectory> makeTrajectories()
+    {
+        return {
+            { "static", [] (double) { return treble_dsp::Parameters(); } },
+            { "cutoff sweep", [] (double x)
+                {
+                    treble_dsp::Parameters p;
+                    p.cutoff = (float)(2000.0 * std::pow(10.0, x));
+                    p.gain = 6.0f;
+                    return p;
+                } },
+            { "gain ramp", [] (double x)
+                {
+                    treble_dsp::Parameters p;
+                    p.gain = (float)(8.0 * x);
+                    p.q = 1.2f;
+                    return p;
+                } },
+            { "mode toggle", [] (double x)
+                {
+                    treble_dsp::Parameters p;
+                    p.cutoff = 5000.0f;
+                    p.q = (float)(0.1 + 1.4 * x);
+                    p.gain = 4.0f;
+                    p.reduceMode = ((int)(x * 8.0) % 2) == 1;
+                    return p;
+                } }
+        };
+    }
+
+    void setParameter (TrebleMakerAudioProcessor& processor, const char* id, float value)
+    {
+        auto* param = processor.apvts.getParameter(id);
+        param->setValueNotifyingHost(param->convertTo0to1(value));
+    }
+
+    void applyParameters (TrebleMakerAudioProcessor& processor, const treble_dsp::Parameters& p)
+    {
+        setParameter(processor, "freq", p.cutoff);
+        setParameter(processor, "gain", p.gain);
+        setParameter(processor, "q", p.q);
+        setParameter(processor, "mode", p.reduceMode ? 1.0f : 0.0f);
+    }
+
+    // renders block by block, timing only the process call
+    template <typename ProcessFn>
+    double renderBlocks (juce::AudioBuffer<float>& audio, const std::vector<treble_dsp::Parameters>& automation,
+                         std::function<void (const treble_dsp::Parameters&)> beforeBlock, ProcessFn&& process)
+    {
+        juce::int64 ticks = 0;
+
+        for (size_t b = 0; b < automation.size(); ++b)
+        {
+            auto start = (int)b * blockSize;
+            auto length = juce::jmin(blockSize, audio.getNumSamples() - start);
+            juce::AudioBuffer<float> block(audio.getArrayOfWritePointers(), audio.getNumChannels(), start, length);
+
+            beforeBlock(automation[b]);
+
+            auto t0 = juce::Time::getHighResolutionTicks();
+            process(block, automation[b]);
+            ticks += juce::Time::getHighResolutionTicks() - t0;
+        }
+
+        return juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e9 / ((double)audio.getNumSamples() * audio.getNumChannels());
+    }
+
+    // the engine meters input and output as it goes (see BlockState), so the
+    // reference is timed taking the same levels, one pass over each side
+    struct LevelMeter
+    {
+        float peak = 0.0f;
+        double sumOfSquares = 0.0;
+
+        void add (const juce::AudioBuffer<float>& block) noexcept
+        {
+            for (int ch = 0; ch < block.getNumChannels(); ++ch)
+            {
+                auto* data = block.getReadPointer(ch);
+
+                for (int s = 0; s < block.getNumSamples(); ++s)
+                {
+                    peak = juce::jmax(peak, std::abs(data[s]));
+                    sumOfSquares += (double)data[s] * data[s];
+                }
+            }
+        }
+    };
+
+    // keeps the reference's metering from being optimised away
+    volatile double levelSink = 0.0;
+
+    double getNumber (const juce::var& object, const juce::Identifier& key, double fallback)
+    {
+        return object.hasProperty(key) ? (double)object[key] : fallback;
+    }
+}
+
+RegressionGate::Options RegressionGate::parseOptions (const juce::ArgumentList& args)
+{
+    Options o;
+
+    // no default, a guessed location could silently point at the wrong file
+    if (!args.containsOption("--baseline"))
+        juce::ConsoleApplication::fail("--regress needs --baseline=path/to/baseline.json (normally Benchmarks/baseline.json)", 1);
+
+    o.baselineFile = args.getFileForOption("--baseline");
+
+    o.updateBaseline = args.containsOption("--update-baseline");
+
+    if (args.containsOption("--repeats"))
+        o.numRepeats = juce::jmax(1, args.getValueForOption("--repeats").getIntValue());
+
+    return o;
+}
+
+RegressionGate::RegressionGate (Options o)
+    : options(std::move(o))
+{
+}
+
+std::vector<treble_dsp::Parameters> RegressionGate::quantise (const Trajectory& trajectory, int numBlocks) const
+{
+    // the plugin's parameters snap to their intervals, so both sides get the snapped values
+    TrebleMakerAudioProcessor processor;
+    std::vector<treble_dsp::Parameters> automation;
+
+    for (int b = 0; b < numBlocks; ++b)
+    {
+        applyParameters(processor, trajectory((double)b / juce::jmax(1, numBlocks - 1)));
+
+        treble_dsp::Parameters p;
+        p.cutoff     = *processor.apvts.getRawParameterValue("freq");
+        p.gain       = *processor.apvts.getRawParameterValue("gain");
+        p.q          = *processor.apvts.getRawParameterValue("q");
+        p.reduceMode = *processor.apvts.getRawParameterValue("mode") > 0.5f;
+        automation.push_back(p);
+    }
+
+    return automation;
+}
+
+RegressionGate::Render RegressionGate::renderReference (const juce::AudioBuffer<float>& input, const std::vector<treble_dsp::Parameters>& automation) const
+{
+    Render result;
+    result.nsPerSample = std::numeric_limits<double>::max();
+
+    for (int r = 0; r < options.numRepeats; ++r)
+    {
+        ReferenceProcessor reference;
+        reference.prepare(sampleRate, blockSize, numChannels);
+
+        LevelMeter inputLevels, outputLevels;
+        juce::AudioBuffer<float> audio(input);
+        auto ns = renderBlocks(audio, automation, [] (const treble_dsp::Parameters&) {},
+                               [&] (juce::AudioBuffer<float>& block, const treble_dsp::Parameters& p)
+                               {
+                                   inputLevels.add(block);
+                                   reference.process(block, p);
+                                   outputLevels.add(block);
+                               });
+
+        levelSink = inputLevels.sumOfSquares + outputLevels.sumOfSquares + inputLevels.peak + outputLevels.peak;
+        result.nsPerSample = juce::jmin(result.nsPerSample, ns);
+
+        if (r == 0)
+            result.output = audio;
+    }
+
+    return result;
+}
+
+RegressionGate::Render RegressionGate::renderEngine (const juce::AudioBuffer<float>& input, const std::vector<treble_dsp::Parameters>& automation) const
+{
+    Render result;
+    result.nsPerSample = std::numeric_limits<double>::max();
+
+    for (int r = 0; r < options.numRepeats; ++r)
+    {
+        treble_dsp::Engine<float, numChannels> engine;
+        engine.prepare(sampleRate);
+
+        juce::AudioBuffer<float> audio(input);
+        auto ns = renderBlocks(audio, automation, [] (const treble_dsp::Parameters&) {},
+                               [&] (juce::AudioBuffer<float>& block, const treble_dsp::Parameters& p)
+                               {
+                                   juce::ScopedNoDenormals noDenormals;
+                                   engine.process(block.getArrayOfWritePointers(), block.getNumChannels(), block.getNumSamples(), p);
+                               });
+
+        result.nsPerSample = juce::jmin(result.nsPerSample, ns);
+    }
+
+    return result;
+}
+
+RegressionGate::Render RegressionGate::renderCurrent (const juce::AudioBuffer<float>& input, const std::vector<treble_dsp::Parameters>& automation) const
+{
+    Render result;
+    result.nsPerSample = std::numeric_limits<double>::max();
+
+    for (int r = 0; r < options.numRepeats; ++r)
+    {
+        TrebleMakerAudioProcessor processor;
+        processor.setPlayConfigDetails(numChannels, numChannels, sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+
+        juce::MidiBuffer midi;
+        juce::AudioBuffer<float> audio(input);
+        auto ns = renderBlocks(audio, automation,
+                               [&] (const treble_dsp::Parameters& p) { applyParameters(processor, p); },
+                               [&] (juce::AudioBuffer<float>& block, const treble_dsp::Parameters&) { processor.processBlock(block, midi); });
+
+        result.nsPerSample = juce::jmin(result.nsPerSample, ns);
+
+        if (r == 0)
+            result.output = audio;
+    }
+
+    return result;
+}
+
+bool RegressionGate::run()
+{
+    auto baseline = juce::JSON::parse(options.baselineFile);
+
+    // --update-baseline is the only thing allowed to start from nothing
+    if (!baseline.isObject())
+    {
+        if (!options.updateBaseline)
+        {
+            std::printf("could not read baseline %s, record one with --update-baseline\n",
+                        options.baselineFile.getFullPathName().toRawUTF8());
+            return false;
+        }
+
+        baseline = juce::var(new juce::DynamicObject());
+    }
+
+    auto tolerance = getNumber(baseline, "tolerance", defaultTolerance);
+    auto maxError  = getNumber(baseline, "max_sample_error", defaultMaxError);
+    auto nullDepth = getNumber(baseline, "min_null_depth_db", defaultNullDepth);
+
+    auto storedTimes = baseline["ns_per_sample"];
+    juce::DynamicObject::Ptr measuredTimes = new juce::DynamicObject();
+
+    if (!options.updateBaseline && (!storedTimes.isObject() || storedTimes.getDynamicObject()->getProperties().isEmpty()))
+    {
+        std::printf("baseline %s has no ns_per_sample entries, record them with --update-baseline on the reference machine\n",
+                    options.baselineFile.getFullPathName().toRawUTF8());
+        return false;
+    }
+
+    auto signals = makeSignals();
+    auto trajectories = makeTrajectories();
+
+    std::printf("TrebleMaker regression gate: %d cases, max error %g, null depth %.0f dB, tolerance %.0f%%\n"
+                "baseline: %s\n\n",
+                (int)(signals.size() * trajectories.size()), maxError, nullDepth, tolerance * 100.0,
+                options.baselineFile.getFullPathName().toRawUTF8());
+
+    // ref and engine ns/s are the dsp alone (same metering on both sides),
+    // ns/s is the whole processBlock, which is what the baseline stores
+    std::printf("  %-24s  %10s  %9s  %10s  %10s  %10s  %10s  %s\n",
+                "case", "max error", "null dB", "ref ns/s", "engine", "ns/s", "baseline", "result");
+
+    bool passed = true;
+    auto numBlocks = (numSamples + blockSize - 1) / blockSize;
+
+    for (auto& signal : signals)
+    {
+        juce::AudioBuffer<float> input(numChannels, numSamples);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int s = 0; s < numSamples; ++s)
+                input.setSample(ch, s, signal.generate(s, ch));
+
+        for (auto& trajectory : trajectories)
+        {
+            auto name = juce::String(signal.name) + " / " + trajectory.name;
+            auto automation = quantise(trajectory.at, numBlocks);
+
+            auto reference = renderReference(input, automation);
+            auto engine    = renderEngine(input, automation);
+            auto current   = renderCurrent(input, automation);
+
+            // sample error and null depth
+            double worstError = 0.0, diffEnergy = 0.0, refEnergy = 0.0;
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                auto* ref = reference.output.getReadPointer(ch);
+                auto* cur = current.output.getReadPointer(ch);
+
+                for (int s = 0; s < numSamples; ++s)
+                {
+                    auto diff = (double)cur[s] - (double)ref[s];
+                    worstError = juce::jmax(worstError, std::abs(diff));
+                    diffEnergy += diff * diff;
+                    refEnergy  += (double)ref[s] * ref[s];
+                }
+            }
+
+            auto nullDb = refEnergy > 0.0 ? juce::Decibels::gainToDecibels(std::sqrt(diffEnergy / refEnergy), -200.0)
+                                          : (diffEnergy > 0.0 ? 0.0 : -200.0);
+
+            juce::StringArray failures;
+
+            if (!(worstError <= maxError))
+                failures.add("error");
+
+            if (refEnergy > 0.0 && !(nullDb <= -nullDepth))
+                failures.add("null");
+
+            // dsp throughput against the reference, measured in this run on this machine
+            if (engine.nsPerSample > reference.nsPerSample * (1.0 + tolerance))
+                failures.add("slower than reference");
+
+            // processBlock against the stored baseline, unless that's what is being recorded
+            auto stored = storedTimes.isObject() ? storedTimes[juce::Identifier(name)] : juce::var();
+            auto storedNs = stored.isVoid() ? 0.0 : (double)stored;
+
+            if (!options.updateBaseline)
+            {
+                if (storedNs <= 0.0)
+                    failures.add("no baseline");
+                else if (current.nsPerSample > storedNs * (1.0 + tolerance))
+                    failures.add("slower than baseline");
+            }
+
+            measuredTimes->setProperty(juce::Identifier(name), current.nsPerSample);
+
+            std::printf("  %-24s  %10.3g  %9.1f  %10.3f  %10.3f  %10.3f  %10s  %s\n",
+                        name.toRawUTF8(), worstError, nullDb, reference.nsPerSample, engine.nsPerSample, current.nsPerSample,
+                        storedNs > 0.0 ? juce::String(storedNs, 3).toRawUTF8() : "-",
+                        failures.isEmpty() ? "ok" : ("FAIL (" + failures.joinIntoString(", ") + ")").toRawUTF8());
+
+            passed = passed && failures.isEmpty();
+        }
+    }
+
+    if (options.updateBaseline)
+    {
+        // never record timings for a build that doesn't match the reference
+        if (!passed)
+        {
+            std::printf("\nnot updating the baseline, fix the failing cases first\n");
+            return false;
+        }
+
+        juce::DynamicObject::Ptr updated = new juce::DynamicObject();
+        updated->setProperty("tolerance", tolerance);
+        updated->setProperty("max_sample_error", maxError);
+        updated->setProperty("min_null_depth_db", nullDepth);
+        updated->setProperty("ns_per_sample", juce::var(measuredTimes.get()));
+
+        if (!options.baselineFile.getParentDirectory().createDirectory()
+             || !options.baselineFile.replaceWithText(juce::JSON::toString(juce::var(updated.get()))))
+        {
+            std::printf("\ncould not write %s\n", options.baselineFile.getFullPathName().toRawUTF8());
+            return false;
+        }
+
+        std::printf("\nbaseline updated: %s\n", options.baselineFile.getFullPathName().toRawUTF8());
+    }
+
+    return passed;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../Source/Core/TrebleMakerEngine.h"
+
+// renders a fixed corpus (sweeps, noise, impulses, silence under several
+// parameter trajectories) through the frozen reference and through the
+// plugin, checks that they null, checks the engine's ns/sample against the
+// reference's in the same run and processBlock's against the stored baseline
+class RegressionGate
+{
+public:
+    struct Options
+    {
+        juce::File baselineFile;
+        bool updateBaseline = false;
+        int  numRepeats = 5; // timing is the fastest of these
+    };
+
+    static Options parseOptions (const juce::ArgumentList& args);
+
+    explicit RegressionGate (Options);
+
+    // returns false if any case failed
+    bool run();
+
+private:
+    using Trajectory = std::function<treble_dsp::Parameters (double)>; // position 0..1
+
+    struct Render
+    {
+        juce::AudioBuffer<float> output;
+        double nsPerSample = 0.0;
+    };
+
+    Render renderReference (const juce::AudioBuffer<float>& input, const std::vector<treble_dsp::Parameters>& automation) const;
+    Render renderEngine (const juce::AudioBuffer<float>& input, const std::vector<treble_dsp::Parameters>& automation) const;
+    Render renderCurrent (const juce::AudioBuffer<float>& input, const std::vector<treble_dsp::Parameters>& automation) const;
+
+    // what the plugin actually runs with once the values went through its parameters
+    std::vector<treble_dsp::Parameters> quantise (const Trajectory& trajectory, int numBlocks) const;
+
+    Options options;
+};
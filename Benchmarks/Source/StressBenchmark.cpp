@@ -0,0 +1,252 @@
+#include "StressBenchmark.h"
+#include "CacheLine.h"
+#include "HeapStats.h"
+#include "../../Source/Core/PluginProcessor.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+namespace
+{
+    juce::Array<int> parseList (const juce::String& text, const juce::Array<int>& fallback)
+    {
+        juce::Array<int> values;
+
+        for (auto& token : juce::StringArray::fromTokens(text, ",", ""))
+            if (token.trim().getIntValue() > 0)
+                values.add(token.trim().getIntValue());
+
+        return values.isEmpty() ? fallback : values;
+    }
+
+    // sorts in place
+    double percentile (std::vector<double>& values, double p)
+    {
+        if (values.empty())
+            return 0.0;
+
+        std::sort(values.begin(), values.end());
+        auto index = (size_t)std::ceil(p * (double)values.size());
+        return values[juce::jlimit<size_t>(0, values.size() - 1, index == 0 ? 0 : index - 1)];
+    }
+
+    double ticksToMs (juce::int64 ticks)
+    {
+        return juce::Time::highResolutionTicksToSeconds(ticks) * 1000.0;
+    }
+
+    // everything one host thread needs, allocated up front. each one gets
+    // its own cache lines, otherwise the harness adds false sharing of its own
+    struct alignas (cache_line::size) Worker
+    {
+        std::vector<juce::AudioProcessor*> instances;
+        std::vector<juce::AudioBuffer<float>> buffers;
+        std::vector<double> cycleMs; // per block, all of this thread's instances
+        juce::MidiBuffer midi;
+    };
+}
+
+StressBenchmark::Options StressBenchmark::parseOptions (const juce::ArgumentList& args)
+{
+    Options o;
+
+    o.instanceCounts = parseList(args.getValueForOption("--instances"), o.instanceCounts);
+    o.threadCounts   = parseList(args.getValueForOption("--threads"), o.threadCounts);
+
+    if (args.containsOption("--rate"))   o.sampleRate = juce::jmax(8000.0, args.getValueForOption("--rate").getDoubleValue());
+    if (args.containsOption("--block"))  o.blockSize  = juce::jmax(1, args.getValueForOption("--block").getIntValue());
+    if (args.containsOption("--blocks")) o.numBlocks  = juce::jmax(1, args.getValueForOption("--blocks").getIntValue());
+
+    return o;
+}
+
+StressBenchmark::StressBenchmark (Options o)
+    : options(std::move(o)),
+      source(2, options.blockSize)
+{
+    // same noise for every instance, copied in before each block
+    juce::Random random(0x7eb1e);
+
+    for (int ch = 0; ch < source.getNumChannels(); ++ch)
+        for (int s = 0; s < source.getNumSamples(); ++s)
+            source.setSample(ch, s, random.nextFloat() * 0.5f - 0.25f);
+}
+
+bool StressBenchmark::run()
+{
+    bool ranAnything = false;
+
+    std::printf("TrebleMaker stress benchmark: %.0f Hz, %d samples/block, %d blocks (deadline %.3f ms)\n",
+                options.sampleRate, options.blockSize, options.numBlocks,
+                1000.0 * options.blockSize / options.sampleRate);
+
+    for (auto numInstances : options.instanceCounts)
+    {
+        numInstances = juce::jlimit(1, 1000, numInstances);
+
+        std::vector<std::unique_ptr<TrebleMakerAudioProcessor>> processors;
+        processors.reserve((size_t)numInstances);
+
+        auto heapBefore = heap_stats::getBytesInUse();
+
+        for (int i = 0; i < numInstances; ++i)
+        {
+            processors.push_back(std::make_unique<TrebleMakerAudioProcessor>());
+            processors.back()->setPlayConfigDetails(2, 2, options.sampleRate, options.blockSize);
+        }
+
+        auto heapConstructed = heap_stats::getBytesInUse();
+        auto allocationsBefore = heap_stats::getNumAllocations();
+        auto prepareStart = juce::Time::getHighResolutionTicks();
+
+        for (auto& p : processors)
+            p->prepareToPlay(options.sampleRate, options.blockSize);
+
+        auto prepareMs = ticksToMs(juce::Time::getHighResolutionTicks() - prepareStart);
+        auto heapPrepared = heap_stats::getBytesInUse();
+        auto prepareAllocations = heap_stats::getNumAllocations() - allocationsBefore;
+
+        std::printf("\n%d instance(s): object %d B, heap after construction %.1f KB, prepareToPlay %.2f us, %.1f KB + %.1f %s (per instance)\n",
+                    numInstances, (int)sizeof(TrebleMakerAudioProcessor),
+                    (double)(heapConstructed - heapBefore) / 1024.0 / numInstances,
+                    prepareMs * 1000.0 / numInstances,
+                    ((double)heapPrepared - (double)heapConstructed) / 1024.0 / numInstances,
+                    (double)prepareAllocations / numInstances, heap_stats::getAllocationsLabel());
+
+        std::vector<juce::AudioProcessor*> instances;
+        for (auto& p : processors)
+            instances.push_back(p.get());
+
+        measureReconfiguration(instances);
+
+        std::printf("  threads   Msamples/s   x realtime   cycle p50 ms   p99 ms   p99.9 ms   max ms\n");
+
+        for (auto numThreads : options.threadCounts)
+        {
+            numThreads = juce::jmin(numThreads, numInstances);
+            auto result = runInstances(instances, numThreads);
+
+            std::printf("  %7d   %10.2f   %10.1f   %12.4f   %6.4f   %8.4f   %6.4f\n",
+                        numThreads, result.samplesPerSecond / 1.0e6,
+                        result.samplesPerSecond / options.sampleRate,
+                        result.cycleP50Ms, result.cycleP99Ms, result.cycleP999Ms, result.cycleMaxMs);
+
+            ranAnything = true;
+        }
+
+        for (auto& p : processors)
+            p->releaseResources();
+    }
+
+    return ranAnything;
+}
+
+void StressBenchmark::measureReconfiguration (const std::vector<juce::AudioProcessor*>& instances)
+{
+    // what the host does on a sample rate switch or an offline bounce toggle:
+    // prepareToPlay again on every instance, then back to the benchmark rate
+    for (auto rate : { options.sampleRate * 2.0, options.sampleRate })
+    {
+        std::vector<double> timesUs;
+        timesUs.reserve(instances.size());
+
+        auto allocationsBefore = heap_stats::getNumAllocations();
+        auto heapBefore = heap_stats::getBytesInUse();
+
+        for (auto* p : instances)
+        {
+            p->setRateAndBufferSizeDetails(rate, options.blockSize);
+
+            auto start = juce::Time::getHighResolutionTicks();
+            p->prepareToPlay(rate, options.blockSize);
+            timesUs.push_back(ticksToMs(juce::Time::getHighResolutionTicks() - start) * 1000.0);
+        }
+
+        auto allocations = heap_stats::getNumAllocations() - allocationsBefore;
+        auto heapDelta = (double)heap_stats::getBytesInUse() - (double)heapBefore;
+
+        double totalUs = 0.0;
+        for (auto t : timesUs)
+            totalUs += t;
+
+        std::printf("  reconfigure to %.0f Hz: %.3f ms total, %.3f us/instance (p99 %.3f, max %.3f), %.1f %s/instance, heap %+.1f KB\n",
+                    rate, totalUs / 1000.0, totalUs / (double)instances.size(),
+                    percentile(timesUs, 0.99), percentile(timesUs, 1.0),
+                    (double)allocations / (double)instances.size(), heap_stats::getAllocationsLabel(), heapDelta / 1024.0);
+    }
+}
+
+StressBenchmark::RunResult StressBenchmark::runInstances (const std::vector<juce::AudioProcessor*>& instances, int numThreads)
+{
+    // round robin, like a host handing tracks to its workers
+    std::vector<Worker> workers((size_t)numThreads);
+
+    for (size_t i = 0; i < instances.size(); ++i)
+        workers[i % workers.size()].instances.push_back(instances[i]);
+
+    for (auto& w : workers)
+    {
+        w.buffers.assign(w.instances.size(), juce::AudioBuffer<float>(2, options.blockSize));
+        w.cycleMs.reserve((size_t)options.numBlocks);
+        w.midi.ensureSize(256);
+    }
+
+    std::atomic<int> numReady { 0 };
+    std::atomic<bool> go { false };
+    std::vector<std::thread> threads;
+
+    for (auto& w : workers)
+    {
+        threads.emplace_back([this, &w, &numReady, &go]
+        {
+            ++numReady;
+            while (!go.load(std::memory_order_acquire))
+                std::this_thread::yield();
+
+            for (int b = 0; b < options.numBlocks; ++b)
+            {
+                juce::int64 cycleTicks = 0;
+
+                for (size_t k = 0; k < w.instances.size(); ++k)
+                {
+                    auto& buffer = w.buffers[k];
+
+                    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                        buffer.copyFrom(ch, 0, source, ch, 0, options.blockSize);
+
+                    auto start = juce::Time::getHighResolutionTicks();
+                    w.instances[k]->processBlock(buffer, w.midi);
+                    cycleTicks += juce::Time::getHighResolutionTicks() - start;
+                }
+
+                w.cycleMs.push_back(ticksToMs(cycleTicks));
+            }
+        });
+    }
+
+    while (numReady.load() < numThreads)
+        std::this_thread::yield();
+
+    auto wallStart = juce::Time::getHighResolutionTicks();
+    go.store(true, std::memory_order_release);
+
+    for (auto& t : threads)
+        t.join();
+
+    auto wallSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - wallStart);
+
+    // tail latency of the slowest thread, that's the one the host waits for
+    RunResult result;
+    result.samplesPerSecond = (double)instances.size() * options.numBlocks * options.blockSize / juce::jmax(1.0e-9, wallSeconds);
+
+    for (auto& w : workers)
+    {
+        result.cycleP50Ms  = juce::jmax(result.cycleP50Ms,  percentile(w.cycleMs, 0.5));
+        result.cycleP99Ms  = juce::jmax(result.cycleP99Ms,  percentile(w.cycleMs, 0.99));
+        result.cycleP999Ms = juce::jmax(result.cycleP999Ms, percentile(w.cycleMs, 0.999));
+        result.cycleMaxMs  = juce::jmax(result.cycleMaxMs,  percentile(w.cycleMs, 1.0));
+    }
+
+    return result;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// runs many processors side by side on a pool of threads, the way a
+// multithreaded host spreads plugin instances across its workers.
+// also times prepareToPlay, first call and sample rate switches
+class StressBenchmark
+{
+public:
+    struct Options
+    {
+        juce::Array<int> instanceCounts { 1, 10, 100, 1000 };
+        juce::Array<int> threadCounts   { 1, 2, 4, 8 };
+        double sampleRate = 48000.0;
+        int    blockSize  = 256;
+        int    numBlocks  = 500;
+    };
+
+    static Options parseOptions (const juce::ArgumentList& args);
+
+    explicit StressBenchmark (Options);
+
+    // prints one table per instance count, returns false if nothing could run
+    bool run();
+
+private:
+    struct RunResult
+    {
+        double samplesPerSecond = 0.0; // aggregate, per channel
+        double cycleP50Ms = 0.0, cycleP99Ms = 0.0, cycleP999Ms = 0.0, cycleMaxMs = 0.0;
+    };
+
+    RunResult runInstances (const std::vector<juce::AudioProcessor*>& instances, int numThreads);
+    void measureReconfiguration (const std::vector<juce::AudioProcessor*>& instances);
+
+    Options options;
+    juce::AudioBuffer<float> source;
+};
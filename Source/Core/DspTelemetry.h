@@ -0,0 +1,97 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <type_traits>
+
+// what the dsp actually did during the last block
+struct DspTelemetry
+{
+    double sampleRate   = 44100.0;
+
+    float  analogFreq   = 8000.0f; // cutoff after drift
+    float  analogQ      = 0.7f;    // q after the gain link
+    float  driveAmount  = 0.0f;    // gain in db
+    float  smoothDrive  = 0.0f;    // saturation drive
+    bool   isReduceMode = false;
+
+    // levels (linear, all channels)
+    float  inputPeak  = 0.0f;
+    float  inputRms   = 0.0f;
+    float  outputPeak = 0.0f;
+    float  outputRms  = 0.0f;
+};
+
+// peak / rms over however many blocks it took for a snapshot to reach the
+// reader, so short host buffers don't drop transients between two frames
+struct LevelAccumulator
+{
+    float peak = 0.0f;
+    double sumOfSquares = 0.0;
+    juce::int64 numSamples = 0;
+
+    // one block's worth, as metered by the engine
+    void add (float blockPeak, double blockSumOfSquares, juce::int64 blockNumSamples) noexcept
+    {
+        peak = juce::jmax(peak, blockPeak);
+        sumOfSquares += blockSumOfSquares;
+        numSamples += blockNumSamples;
+    }
+
+    void add (const LevelAccumulator& other) noexcept
+    {
+        peak = juce::jmax(peak, other.peak);
+        sumOfSquares += other.sumOfSquares;
+        numSamples += other.numSamples;
+    }
+
+    float getRms() const noexcept
+    {
+        return numSamples > 0 ? (float)std::sqrt(sumOfSquares / (double)numSamples) : 0.0f;
+    }
+};
+
+// wait-free single producer / single consumer triple buffer.
+// the writer and the reader each own a slot, the third one is handed
+// between them with a single atomic exchange, so neither side ever waits
+// and the reader always sees a complete snapshot.
+template <typename T>
+class TripleBuffer
+{
+public:
+    static_assert (std::is_trivially_copyable_v<T>, "slots are copied on the audio thread");
+
+    // audio thread, returns true if the reader had picked up the previous
+    // snapshot, false if that one was replaced without ever being seen
+    bool write (const T& value) noexcept
+    {
+        slots[(size_t) backIndex] = value;
+        auto previous = middle.exchange (backIndex | dirtyBit, std::memory_order_acq_rel);
+        backIndex = previous & indexMask;
+        return (previous & dirtyBit) == 0;
+    }
+
+    // reader thread, returns true if a new snapshot was picked up
+    bool pull() noexcept
+    {
+        if ((middle.load (std::memory_order_relaxed) & dirtyBit) == 0)
+            return false;
+
+        frontIndex = middle.exchange (frontIndex, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    // reader thread, latest snapshot picked up by pull()
+    const T& get() const noexcept { return slots[(size_t) frontIndex]; }
+
+private:
+    static constexpr int indexMask = 0x3;
+    static constexpr int dirtyBit  = 0x4;
+
+    std::array<T, 3> slots {};
+
+    int backIndex  = 0; // writer only
+    int frontIndex = 2; // reader only
+    std::atomic<int> middle { 1 };
+};
@@ -36,33 +36,27 @@ juce::AudioProcessorValueTreeState::ParameterLayout TrebleMakerAudioProcessor::c
     return { params.begin(), params.end() };
 }
 
-void TrebleMakerAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
+bool TrebleMakerAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
 {
-    juce::dsp::ProcessSpec spec;
-    spec.sampleRate = sampleRate;
-    spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = getTotalNumOutputChannels();
-
-    filters.clear();
-    for (int i = 0; i < getTotalNumOutputChannels(); ++i)
-    {
-        auto filter = std::make_unique<juce::dsp::StateVariableTPTFilter<float>>();
-        filter->prepare(spec);
-        // juce's tpt filter doesn't have a shelf mode, so i use a highpass
-        // and mix it in later (dry + hp = boost, dry - hp = cut)
-        filter->setType(juce::dsp::StateVariableTPTFilterType::highpass);
-        filters.push_back(std::move(filter));
-    }
-    
-    dryBuffer.setSize(getTotalNumInputChannels(), samplesPerBlock);
-    
-    driftPhase = 0.0;
+    // the engine is sized for stereo, in and out have to match
+    auto out = layouts.getMainOutputChannelSet();
+
+    if (out != juce::AudioChannelSet::mono() && out != juce::AudioChannelSet::stereo())
+        return false;
+
+    return out == layouts.getMainInputChannelSet();
+}
+
+void TrebleMakerAudioProcessor::prepareToPlay (double sampleRate, int /*samplesPerBlock*/)
+{
+    // all dsp state lives inside the engine (stereo, any block size), so a
+    // reconfiguration is just a state reset + sample rate dependent constants
+    engine.prepare(sampleRate);
 }
 
 void TrebleMakerAudioProcessor::releaseResources()
 {
-    dryBuffer.setSize(0, 0);
-    filters.clear();
+    // nothing to free, the engine is kept for the next prepareToPlay
 }
 
 void TrebleMakerAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& /*midiMessages*/)
@@ -74,113 +68,52 @@ void TrebleMakerAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear(i, 0, buffer.getNumSamples());
 
-    float currentCutoff = *apvts.getRawParameterValue("freq");
-    float driveAmount   = *apvts.getRawParameterValue("gain");
-    float currentQ      = *apvts.getRawParameterValue("q");
-    
-    bool isReduceMode = *apvts.getRawParameterValue("mode") > 0.5f;
-
-    // analog drift
-    double driftAmount = std::sin(driftPhase) * 0.005;
-    
-    // lfo increment
-    driftPhase += (2.0 * juce::MathConstants<double>::pi * 0.2) / getSampleRate() * buffer.getNumSamples();
-    
-    if (driftPhase > juce::MathConstants<double>::twoPi) 
-        driftPhase -= juce::MathConstants<double>::twoPi;
-    
-    float analogFreq = currentCutoff * (1.0f + (float)driftAmount);
-    
-    // link q to gain
-    float analogQ = currentQ + (driveAmount * 0.02f); 
-
-    for (auto& filter : filters)
-    {
-        filter->setCutoffFrequency(analogFreq);
-        filter->setResonance(analogQ);
-    }
-
-    // copy dry
-    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
-    {
-        dryBuffer.copyFrom(ch, 0, buffer, ch, 0, buffer.getNumSamples());
-    }
-
-    // process filters
-    juce::dsp::AudioBlock<float> block(buffer);
-    
-    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
-    {
-        if (ch < filters.size())
-        {
-            auto singleChannelBlock = block.getSingleChannelBlock(ch);
-            juce::dsp::ProcessContextReplacing<float> context(singleChannelBlock);
-            filters[ch]->process(context);
-        }
-    }
-    
-    // mix
-    if (!isReduceMode)
-    {
-        // boost
-        float boostAmount = juce::Decibels::decibelsToGain(driveAmount) - 1.0f;
-        
-        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
-        {
-            buffer.applyGain(ch, 0, buffer.getNumSamples(), boostAmount);
-            buffer.addFrom(ch, 0, dryBuffer, ch, 0, buffer.getNumSamples());
-        }
-    }
-    else
-    {
-        // cut
-        float cutAmount = juce::Decibels::decibelsToGain(driveAmount); 
-        
-        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
-        {
-            buffer.applyGain(ch, 0, buffer.getNumSamples(), cutAmount);
-            
-            auto* dryData = dryBuffer.getReadPointer(ch);
-            auto* wetData = buffer.getWritePointer(ch);
-            
-            for (int s = 0; s < buffer.getNumSamples(); ++s)
-            {
-                wetData[s] = dryData[s] - wetData[s];
-            }
-        }
-    }
-
-    // saturation
-    if (!isReduceMode && driveAmount > 0.1f)
-    {
-        float targetDrive = 1.0f + (driveAmount * 0.08f); 
-        smoothDrive = smoothDrive * 0.95f + targetDrive * 0.05f;
-
-        const float dcBias = 0.15f; 
-
-        for (int channel = 0; channel < totalNumInputChannels; ++channel)
-        {
-            auto* channelData = buffer.getWritePointer(channel);
-            
-            for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-            {
-                float in = channelData[sample];
-
-                float x = in * smoothDrive;
-                x += dcBias;
-
-                // soft clip tanh
-                float saturated = std::tanh(x);
-                float out = saturated - std::tanh(dcBias);
-                
-                out /= (std::tanh(smoothDrive + dcBias) - std::tanh(dcBias));
-
-                float blend = juce::jmin(driveAmount / 12.0f, 1.0f);
-                
-                channelData[sample] = (out * blend) + (in * (1.0f - blend));
-            }
-        }
-    }
+    treble_dsp::Parameters params;
+    params.cutoff     = *apvts.getRawParameterValue("freq");
+    params.gain       = *apvts.getRawParameterValue("gain");
+    params.q          = *apvts.getRawParameterValue("q");
+    params.reduceMode = *apvts.getRawParameterValue("mode") > 0.5f;
+
+    DspTelemetry snapshot;
+    snapshot.sampleRate   = getSampleRate();
+    snapshot.driveAmount  = params.gain;
+    snapshot.isReduceMode = params.reduceMode;
+
+    // in place, straight on the host's channel pointers. the engine meters
+    // input and output in the same pass, no extra trips over the buffer
+    engine.process(buffer.getArrayOfWritePointers(),
+                   juce::jmin(buffer.getNumChannels(), Engine::maxChannels),
+                   buffer.getNumSamples(), params);
+
+    auto& state = engine.getLastBlockState();
+    snapshot.analogFreq  = state.analogFreq;
+    snapshot.analogQ     = state.analogQ;
+    snapshot.smoothDrive = state.smoothDrive;
+
+    Levels block;
+    block.numFrames = buffer.getNumSamples();
+    block.input.add(state.inputPeak, state.inputSumOfSquares, state.numSamples);
+    block.output.add(state.outputPeak, state.outputSumOfSquares, state.numSamples);
+
+    // publish everything since the last snapshot the editor actually saw.
+    // nothing picked up for longer than the editor's staleness window means
+    // there's no editor reading, don't hold an all-time peak for when it opens
+    if (undelivered.numFrames > (juce::int64)(getSampleRate() * 0.25))
+        undelivered = {};
+
+    undelivered.input.add(block.input);
+    undelivered.output.add(block.output);
+    undelivered.numFrames += block.numFrames;
+
+    snapshot.inputPeak  = undelivered.input.peak;
+    snapshot.inputRms   = undelivered.input.getRms();
+    snapshot.outputPeak = undelivered.output.peak;
+    snapshot.outputRms  = undelivered.output.getRms();
+
+    // if the previous snapshot was picked up, only what came after it is still
+    // undelivered. if it was replaced unseen, this one carries its levels too
+    if (telemetry.write(snapshot))
+        undelivered = block;
 }
 
 TrebleMakerAudioProcessor::~TrebleMakerAudioProcessor()
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "DspTelemetry.h"
+#include "TrebleMakerEngine.h"
 
 class TrebleMakerAudioProcessor  : public juce::AudioProcessor
 {
@@ -11,6 +13,8 @@ public:
     void prepareToPlay (double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
 
+    bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
+
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
 
     juce::AudioProcessorEditor* createEditor() override;
@@ -35,20 +39,24 @@ public:
     // parameter state
     juce::AudioProcessorValueTreeState apvts;
 
+    // dsp state + levels, published once per block for the editor
+    TripleBuffer<DspTelemetry> telemetry;
+
 private:
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
-    // tpt filters for better modulation response
-    std::vector<std::unique_ptr<juce::dsp::StateVariableTPTFilter<float>>> filters;
-    
-    // dry buffer for mix
-    juce::AudioBuffer<float> dryBuffer;
-
-    // drift lfo
-    double driftPhase = 0.0;
-    
-    // smoothed drive
-    float  smoothDrive = 0.0f;
+    // levels not yet known to have reached the editor
+    struct Levels
+    {
+        LevelAccumulator input, output;
+        juce::int64 numFrames = 0;
+    };
+
+    Levels undelivered;
+
+    // the actual dsp (tpt highpass, shelf mix, drift, saturation)
+    using Engine = treble_dsp::Engine<float, 2>;
+    Engine engine;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TrebleMakerAudioProcessor)
 };
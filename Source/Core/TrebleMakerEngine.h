@@ -0,0 +1,282 @@
+#pragma once
+
+// header-only treble maker dsp, no juce needed.
+// same signal path as the plugin: tpt highpass mixed back with the dry
+// signal (dry + hp = boost, dry - hp = cut), slow cutoff drift and tanh
+// saturation. everything runs per sample in place, so there is no dry
+// copy and no allocation anywhere. input and output levels are metered in
+// the same pass.
+//
+// the caller is expected to have denormals flushed (juce::ScopedNoDenormals
+// or the equivalent) while processing.
+
+#include <array>
+#include <cmath>
+#include <type_traits>
+
+namespace treble_dsp
+{
+    // same units and ranges as the plugin parameters. the filter is kept
+    // stable whatever comes in: the drifted cutoff is clamped to below
+    // nyquist (0.49 * sample rate) and the gain linked q to above zero
+    struct Parameters
+    {
+        float cutoff     = 8000.0f; // hz, 2k - 20k
+        float gain       = 2.0f;    // db, 0 - 8
+        float q          = 0.7f;    // 0.1 - 1.5
+        bool  reduceMode = false;
+    };
+
+    // what the last block actually ran with
+    struct BlockState
+    {
+        float analogFreq  = 0.0f; // cutoff after drift
+        float analogQ     = 0.0f; // q after the gain link
+        float smoothDrive = 0.0f;
+
+        // levels over every processed channel
+        float  inputPeak  = 0.0f, outputPeak = 0.0f;
+        double inputSumOfSquares = 0.0, outputSumOfSquares = 0.0;
+        long long numSamples = 0; // frames * channels
+    };
+
+    template <typename SampleType, int NumChannels>
+    class Engine
+    {
+    public:
+        static_assert (std::is_floating_point_v<SampleType>, "floating point samples only");
+        static_assert (NumChannels > 0, "need at least one channel");
+
+        static constexpr int maxChannels = NumChannels;
+
+        // all state lives inline, so (re)preparing never allocates, it just
+        // resets the filters and recomputes what depends on the sample rate
+        void prepare (double newSampleRate) noexcept
+        {
+            sampleRate = newSampleRate;
+            driftIncrement = sampleRate > 0.0 ? (2.0 * pi * 0.2) / sampleRate : 0.0;
+            reset();
+        }
+
+        // clears the filter memory and restarts the drift lfo
+        void reset() noexcept
+        {
+            s1.fill(SampleType());
+            s2.fill(SampleType());
+            driftPhase = 0.0;
+        }
+
+        // planar, one pointer per channel. channels past NumChannels are
+        // passed through untouched
+        void process (SampleType* const* channels, int numChannels, int numSamples, const Parameters& params) noexcept
+        {
+            auto numProcessed = numChannels < NumChannels ? numChannels : NumChannels;
+
+            if (!beginBlock(params, numSamples))
+                return;
+
+            Meter input, output;
+
+            for (int ch = 0; ch < numProcessed; ++ch)
+            {
+                auto* data = channels[ch];
+
+                for (int s = 0; s < numSamples; ++s)
+                {
+                    auto in = data[s];
+                    auto out = processSample(ch, in);
+                    data[s] = out;
+
+                    input.add(in);
+                    output.add(out);
+                }
+            }
+
+            endBlock(numProcessed, numSamples, input, output);
+        }
+
+        // interleaved, numChannels samples per frame. channels past
+        // NumChannels are passed through untouched
+        void processInterleaved (SampleType* data, int numChannels, int numFrames, const Parameters& params) noexcept
+        {
+            auto numProcessed = numChannels < NumChannels ? numChannels : NumChannels;
+
+            if (!beginBlock(params, numFrames))
+                return;
+
+            Meter input, output;
+
+            for (int frame = 0; frame < numFrames; ++frame)
+            {
+                auto* frameData = data + (size_t)frame * (size_t)numChannels;
+
+                for (int ch = 0; ch < numProcessed; ++ch)
+                {
+                    auto in = frameData[ch];
+                    auto out = processSample(ch, in);
+                    frameData[ch] = out;
+
+                    input.add(in);
+                    output.add(out);
+                }
+            }
+
+            endBlock(numProcessed, numFrames, input, output);
+        }
+
+        const BlockState& getLastBlockState() const noexcept { return lastBlock; }
+
+    private:
+        static constexpr double pi = 3.141592653589793238;
+        static constexpr float dcBias = 0.15f;
+
+        // tan() runs off to infinity at nyquist and a q of zero makes R2
+        // infinite, juce's tpt filter asserted on both
+        static constexpr float minCutoff = 1.0f;         // hz
+        static constexpr double maxCutoffRatio = 0.49;   // of the sample rate
+        static constexpr float minQ = 0.01f;
+
+        struct Meter
+        {
+            SampleType peak {};
+            double sumOfSquares = 0.0;
+
+            void add (SampleType x) noexcept
+            {
+                auto magnitude = std::abs(x);
+                peak = magnitude > peak ? magnitude : peak;
+                sumOfSquares += (double)x * (double)x;
+            }
+        };
+
+        static float decibelsToGain (float db) noexcept
+        {
+            return db > -100.0f ? std::pow(10.0f, db * 0.05f) : 0.0f;
+        }
+
+        // per block setup, returns false if the engine isn't prepared
+        bool beginBlock (const Parameters& params, int numSamples) noexcept
+        {
+            if (sampleRate <= 0.0)
+                return false;
+
+            // analog drift
+            double driftAmount = std::sin(driftPhase) * 0.005;
+
+            driftPhase += driftIncrement * numSamples;
+
+            if (driftPhase > 2.0 * pi)
+                driftPhase -= 2.0 * pi;
+
+            float analogFreq = params.cutoff * (1.0f + (float)driftAmount);
+            float maxCutoff = (float)(sampleRate * maxCutoffRatio);
+
+            // written so nan ends up at the limit too
+            analogFreq = analogFreq > minCutoff ? (analogFreq < maxCutoff ? analogFreq : maxCutoff) : minCutoff;
+
+            // link q to gain
+            float analogQ = params.q + (params.gain * 0.02f);
+            analogQ = analogQ > minQ ? analogQ : minQ;
+
+            // tpt highpass coefficients
+            g  = static_cast<SampleType> (std::tan(pi * (double)static_cast<SampleType> (analogFreq) / sampleRate));
+            R2 = static_cast<SampleType> (1.0 / (double)static_cast<SampleType> (analogQ));
+            h  = static_cast<SampleType> (1.0 / (1.0 + R2 * g + g * g));
+
+            // mix: boost scales the highpass by (G - 1), cut by G
+            reduceMode = params.reduceMode;
+            mixGain = static_cast<SampleType> (reduceMode ? decibelsToGain(params.gain)
+                                                          : decibelsToGain(params.gain) - 1.0f);
+
+            // saturation
+            saturate = !reduceMode && params.gain > 0.1f;
+
+            if (saturate)
+            {
+                float targetDrive = 1.0f + (params.gain * 0.08f);
+                smoothDrive = smoothDrive * 0.95f + targetDrive * 0.05f;
+
+                drive = static_cast<SampleType> (smoothDrive);
+                tanhBias = std::tanh(static_cast<SampleType> (dcBias));
+                normaliser = std::tanh(drive + static_cast<SampleType> (dcBias)) - tanhBias;
+
+                float blendAmount = params.gain / 12.0f;
+                blend = static_cast<SampleType> (blendAmount < 1.0f ? blendAmount : 1.0f);
+            }
+
+            lastBlock = { analogFreq, analogQ, smoothDrive };
+            return true;
+        }
+
+        SampleType processSample (int ch, SampleType in) noexcept
+        {
+            auto& ls1 = s1[(size_t)ch];
+            auto& ls2 = s2[(size_t)ch];
+
+            // tpt state variable filter, highpass output
+            auto yHP = h * (in - ls1 * (g + R2) - ls2);
+
+            auto yBP = yHP * g + ls1;
+            ls1      = yHP * g + yBP;
+
+            auto yLP = yBP * g + ls2;
+            ls2      = yBP * g + yLP;
+
+            // mix
+            SampleType y = reduceMode ? in - yHP * mixGain
+                                      : yHP * mixGain + in;
+
+            if (!saturate)
+                return y;
+
+            // soft clip tanh
+            SampleType x = y * drive;
+            x += static_cast<SampleType> (dcBias);
+
+            SampleType out = std::tanh(x) - tanhBias;
+            out /= normaliser;
+
+            return (out * blend) + (y * (static_cast<SampleType> (1) - blend));
+        }
+
+        void endBlock (int numChannels, int numSamples, const Meter& input, const Meter& output) noexcept
+        {
+            // same denormal guard juce's tpt filter applies after every block
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                snapToZero(s1[(size_t)ch]);
+                snapToZero(s2[(size_t)ch]);
+            }
+
+            lastBlock.inputPeak          = static_cast<float> (input.peak);
+            lastBlock.outputPeak         = static_cast<float> (output.peak);
+            lastBlock.inputSumOfSquares  = input.sumOfSquares;
+            lastBlock.outputSumOfSquares = output.sumOfSquares;
+            lastBlock.numSamples         = (long long)numChannels * numSamples;
+        }
+
+        static void snapToZero (SampleType& value) noexcept
+        {
+            if (!(value < static_cast<SampleType> (-1.0e-8) || value > static_cast<SampleType> (1.0e-8)))
+                value = SampleType();
+        }
+
+        // filter memory, one pair per channel
+        std::array<SampleType, (size_t)NumChannels> s1 {};
+        std::array<SampleType, (size_t)NumChannels> s2 {};
+
+        double driftPhase = 0.0;
+        float  smoothDrive = 0.0f;
+        double sampleRate = 0.0;
+        double driftIncrement = 0.0; // per sample
+
+        // current block
+        SampleType g {}, R2 {}, h {};
+        SampleType mixGain {};
+        SampleType drive {}, tanhBias {}, normaliser {}, blend {};
+        bool reduceMode = false;
+        bool saturate = false;
+
+        BlockState lastBlock;
+    };
+}
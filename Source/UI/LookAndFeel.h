@@ -38,6 +38,39 @@ public:
         auto center = bounds.getCentre();
         auto toAngle = rotaryStartAngle + sliderPos * (rotaryEndAngle - rotaryStartAngle);
 
+        // the face doesn't move, use the pre-rendered one if it's for this size
+        if (knobFace.isValid() && knobFaceSize == juce::Point<int>(width, height))
+            g.drawImage(knobFace, bounds);
+        else
+            drawKnobFace(g, bounds);
+
+        auto faceRadius = radius * 0.9f;
+
+        // pointer
+        juce::Path p;
+        auto tickW = 3.0f;
+        auto tickH = faceRadius * 0.35f;
+        p.addRectangle(-tickW * 0.5f, -faceRadius * 0.85f, tickW, tickH);
+        
+        // rotate
+        p.applyTransform(juce::AffineTransform::rotation(toAngle).translated(center.x, center.y));
+        
+        // tick shadow (for depth)
+        g.setColour(juce::Colours::black.withAlpha(0.3f));
+        g.fillPath(p, juce::AffineTransform::translation(0.5f, 1.0f));
+
+        // tick fill
+        g.setColour(theme_colors::knobTick);
+        g.fillPath(p);
+    }
+
+    // everything but the pointer (shadow, body, milled texture, face, bevel).
+    // static, so it can be rendered off the message thread
+    static void drawKnobFace(juce::Graphics& g, juce::Rectangle<float> bounds)
+    {
+        auto radius = juce::jmin(bounds.getWidth(), bounds.getHeight()) / 2.0f - 4.0f;
+        auto center = bounds.getCentre();
+
         // drop shadow
         g.setGradientFill(juce::ColourGradient(juce::Colours::black.withAlpha(0.35f), center.x, center.y + radius,
                                                juce::Colours::transparentBlack, center.x, center.y + radius + 8.0f, false));
@@ -75,23 +108,13 @@ public:
         // bevel
         g.setColour(juce::Colours::white.withAlpha(0.6f));
         g.drawEllipse(center.x - faceRadius, center.y - faceRadius, faceRadius * 2.0f, faceRadius * 2.0f, 1.5f);
+    }
 
-        // pointer
-        juce::Path p;
-        auto tickW = 3.0f;
-        auto tickH = faceRadius * 0.35f;
-        p.addRectangle(-tickW * 0.5f, -faceRadius * 0.85f, tickW, tickH);
-        
-        // rotate
-        p.applyTransform(juce::AffineTransform::rotation(toAngle).translated(center.x, center.y));
-        
-        // tick shadow (for depth)
-        g.setColour(juce::Colours::black.withAlpha(0.3f));
-        g.fillPath(p, juce::AffineTransform::translation(0.5f, 1.0f));
-
-        // tick fill
-        g.setColour(theme_colors::knobTick);
-        g.fillPath(p);
+    // pre-rendered face for knobs of the given size, set on the message thread
+    void setKnobFace(juce::Image image, juce::Point<int> size)
+    {
+        knobFace = image;
+        knobFaceSize = size;
     }
     
     // button
@@ -189,4 +212,8 @@ public:
     {
         return juce::Font(juce::FontOptions("Helvetica", 13.0f, juce::Font::bold));
     }
+
+private:
+    juce::Image knobFace;
+    juce::Point<int> knobFaceSize;
 };
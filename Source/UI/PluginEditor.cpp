@@ -50,6 +50,11 @@ TrebleMakerEditor::TrebleMakerEditor (TrebleMakerAudioProcessor& p)
 
 TrebleMakerEditor::~TrebleMakerEditor()
 {
+    // jobs use the editor. a running job bails out at its next generation
+    // check, so wait for it however long that takes rather than time out
+    // and have the pool's own destructor block anyway
+    ++staticLayerGeneration;
+    renderPool.removeAllJobs(true, -1);
     setLookAndFeel(nullptr);
 }
 
@@ -57,13 +62,111 @@ void TrebleMakerEditor::paint (juce::Graphics& g)
 {
     auto bounds = getLocalBounds().toFloat();
     
-    g.fillAll(theme_colors::background);
-    drawGrid(g, bounds);
+    // first paint, or moved to a display with a different backing scale, the
+    // raster is out of date. only the context knows the physical pixel scale
+    auto pixelScale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    
+    if (pixelScale != staticLayerScale)
+    {
+        staticLayerScale = pixelScale;
+        renderStaticLayerAsync();
+    }
     
+    // static layers come from the background raster. while a resize is being
+    // re-rendered the previous raster is stretched to fit, and only the very
+    // first frame (nothing rendered yet) is drawn directly
+    if (staticLayer.isValid())
+        g.drawImage(staticLayer, bounds);
+    else
+        drawStaticLayer(g, bounds);
+    
+    drawScreen(g, getScreenArea(bounds));
+}
+
+juce::Rectangle<float> TrebleMakerEditor::getScreenArea(juce::Rectangle<float> bounds)
+{
     auto screenArea = bounds.removeFromTop(bounds.getHeight() * 0.55f).reduced(25.0f);
     screenArea.removeFromTop(20.0f); // Space for title
     
-    drawScreen(g, screenArea);
+    return screenArea;
+}
+
+void TrebleMakerEditor::drawStaticLayer(juce::Graphics& g, juce::Rectangle<float> bounds)
+{
+    g.fillAll(theme_colors::background);
+    drawGrid(g, bounds);
+    drawScreenBackground(g, getScreenArea(bounds));
+}
+
+void TrebleMakerEditor::renderStaticLayerAsync()
+{
+    auto size = getLocalBounds();
+    auto knobSize = freqSlider.getLocalBounds(); // all knobs are the same size
+    auto scale = staticLayerScale;
+    auto generation = ++staticLayerGeneration;
+    
+    // nothing painted yet means the pixel scale isn't known, paint asks again
+    if (size.isEmpty() || scale <= 0.0f)
+        return;
+    
+    // huge windows get a capped raster, stretched to fit like during a resize
+    auto layerScale = juce::jmin(scale, (float)maxStaticLayerSize / (float)juce::jmax(size.getWidth(), size.getHeight()));
+    
+    // a newer size supersedes anything still queued
+    renderPool.removeAllJobs(false, 0);
+    
+    // created here, SafePointer isn't thread safe
+    juce::Component::SafePointer<TrebleMakerEditor> safeThis(this);
+    
+    renderPool.addJob([this, safeThis, size, knobSize, scale, layerScale, generation]
+    {
+        // superseded while queued or while drawing, e.g. during a drag
+        auto isStale = [this, generation] { return generation != staticLayerGeneration.load(); };
+        
+        if (isStale())
+            return;
+        
+        // software image, so it can be drawn into off the message thread
+        juce::Image image(juce::Image::RGB,
+                          juce::jmax(1, juce::roundToInt((float)size.getWidth() * layerScale)),
+                          juce::jmax(1, juce::roundToInt((float)size.getHeight() * layerScale)),
+                          false, juce::SoftwareImageType());
+        
+        if (isStale())
+            return;
+        
+        {
+            juce::Graphics g(image);
+            g.addTransform(juce::AffineTransform::scale(layerScale));
+            drawStaticLayer(g, size.toFloat());
+        }
+        
+        // knob faces (the pointer is drawn live on top)
+        juce::Image knobFace;
+        
+        if (!knobSize.isEmpty() && !isStale())
+        {
+            knobFace = juce::Image(juce::Image::ARGB,
+                                   juce::jmax(1, juce::roundToInt((float)knobSize.getWidth() * scale)),
+                                   juce::jmax(1, juce::roundToInt((float)knobSize.getHeight() * scale)),
+                                   true, juce::SoftwareImageType());
+            
+            juce::Graphics g(knobFace);
+            g.addTransform(juce::AffineTransform::scale(scale));
+            IndustrialLookAndFeel::drawKnobFace(g, knobSize.toFloat());
+        }
+        
+        // swap in on the message thread, paint never sees a half drawn image
+        juce::MessageManager::callAsync([safeThis, image, knobFace, knobSize, generation]
+        {
+            if (safeThis != nullptr && generation == safeThis->staticLayerGeneration.load())
+            {
+                safeThis->staticLayer = image;
+                safeThis->industrialLookAndFeel.setKnobFace(knobFace, { knobSize.getWidth(), knobSize.getHeight() });
+                safeThis->repaint();
+            }
+        });
+    });
 }
 
 void TrebleMakerEditor::drawGrid(juce::Graphics& g, juce::Rectangle<float> bounds)
@@ -79,7 +182,7 @@ void TrebleMakerEditor::drawGrid(juce::Graphics& g, juce::Rectangle<float> bound
         g.drawHorizontalLine((int)y, 0.0f, bounds.getWidth());
 }
 
-void TrebleMakerEditor::drawScreen(juce::Graphics& g, juce::Rectangle<float> bounds)
+void TrebleMakerEditor::drawScreenBackground(juce::Graphics& g, juce::Rectangle<float> bounds)
 {
     // bezel
     juce::ColourGradient bezelGrad(theme_colors::screenBezelStart, 0, bounds.getY(),
@@ -114,6 +217,16 @@ void TrebleMakerEditor::drawScreen(juce::Graphics& g, juce::Rectangle<float> bou
                                            juce::Colours::transparentBlack, inner.getX() + 20.0f, 0, false));
     g.fillRect(inner.getX(), inner.getY(), 20.0f, inner.getHeight());
     
+    g.restoreState();
+}
+
+void TrebleMakerEditor::drawScreen(juce::Graphics& g, juce::Rectangle<float> bounds)
+{
+    auto inner = bounds.reduced(10.0f); // thick bezel
+    
+    g.saveState();
+    g.reduceClipRegion(inner.toNearestInt());
+    
     // EQ Curve
     if (!eqCurve.empty())
     {
@@ -161,6 +274,8 @@ void TrebleMakerEditor::drawScreen(juce::Graphics& g, juce::Rectangle<float> bou
         g.strokePath(strokePath, juce::PathStrokeType(2.5f, juce::PathStrokeType::curved, juce::PathStrokeType::rounded));
     }
     
+    drawMeters(g, inner);
+    
     g.restoreState();
     
     // bezel inner border (highlight)
@@ -172,6 +287,34 @@ void TrebleMakerEditor::drawScreen(juce::Graphics& g, juce::Rectangle<float> bou
     g.drawRoundedRectangle(inner, 4.0f, 1.0f);
 }
 
+void TrebleMakerEditor::drawMeters(juce::Graphics& g, juce::Rectangle<float> bounds)
+{
+    // in/out bars on the right edge of the screen
+    auto area = bounds.reduced(8.0f).removeFromRight(13.0f);
+    
+    auto toY = [area](float level)
+    {
+        float db = juce::Decibels::gainToDecibels(level, -60.0f);
+        return juce::jmap(juce::jlimit(-60.0f, 6.0f, db), -60.0f, 6.0f, area.getBottom(), area.getY());
+    };
+    
+    auto drawBar = [&](juce::Rectangle<float> bar, float peak, float rms)
+    {
+        g.setColour(juce::Colours::black.withAlpha(0.08f));
+        g.fillRect(bar);
+        
+        g.setColour(theme_colors::screenRed.withAlpha(0.6f));
+        g.fillRect(bar.withTop(toY(rms)));
+        
+        g.setColour(theme_colors::textDark);
+        g.fillRect(bar.getX(), toY(peak) - 1.0f, bar.getWidth(), 2.0f);
+    };
+    
+    drawBar(area.removeFromLeft(5.0f), inPeakDisplay, inRmsDisplay);
+    area.removeFromLeft(3.0f);
+    drawBar(area, outPeakDisplay, outRmsDisplay);
+}
+
 void TrebleMakerEditor::resized()
 {
     auto bounds = getLocalBounds();
@@ -199,6 +342,9 @@ void TrebleMakerEditor::resized()
     // button
     // to the right of the knobs
     reduceButton.setBounds(startX + 3 * (knobSize + gap) + 20, y + 25, 120, 40);
+    
+    // after the knobs got their size
+    renderStaticLayerAsync();
 }
 
 void TrebleMakerEditor::updateCurve()
@@ -208,10 +354,23 @@ void TrebleMakerEditor::updateCurve()
     static float smoothBoost = 0.0f;
     static float smoothFocus = 0.5f; // Q
     
-    float targetFreq = freqSlider.getValue();
-    float targetBoost = boostSlider.getValue();
-    float targetFocus = focusSlider.getValue();
-    bool isReduce = reduceButton.getToggleState();
+    // pick up what the dsp is really doing
+    auto now = juce::Time::getMillisecondCounterHiRes();
+    
+    if (audioProcessor.telemetry.pull())
+    {
+        dsp = audioProcessor.telemetry.get();
+        lastTelemetryMs = now;
+    }
+    
+    // no blocks for a while (transport stopped, host not processing),
+    // fall back to the sliders so the curve still follows the knobs
+    bool isLive = (now - lastTelemetryMs) < 250.0;
+    
+    float targetFreq = isLive ? dsp.analogFreq : (float)freqSlider.getValue();
+    float targetBoost = isLive ? dsp.driveAmount : (float)boostSlider.getValue();
+    float targetFocus = isLive ? dsp.analogQ : (float)(focusSlider.getValue() + boostSlider.getValue() * 0.02);
+    bool isReduce = isLive ? dsp.isReduceMode : reduceButton.getToggleState();
     
     // simple smoothing coefficient
     float alpha = 0.15f;
@@ -220,7 +379,9 @@ void TrebleMakerEditor::updateCurve()
     smoothBoost += (targetBoost - smoothBoost) * alpha;
     smoothFocus += (targetFocus - smoothFocus) * alpha;
     
-    double sampleRate = 44100.0;
+    double sampleRate = isLive ? dsp.sampleRate : audioProcessor.getSampleRate();
+    if (sampleRate <= 0.0) sampleRate = 44100.0;
+    
     double w0 = 2.0 * juce::MathConstants<double>::pi * smoothFreq / sampleRate;
     double Q = juce::jmax(0.1f, smoothFocus);
     double alpha_filter = std::sin(w0) / (2.0 * Q);
@@ -277,6 +438,8 @@ void TrebleMakerEditor::updateCurve()
     
     phase += 0.05f; // slower speed
     
+    updateMeters(isLive);
+    
     // Update button text
     if (reduceButton.getToggleState())
         reduceButton.setButtonText("BOOST");
@@ -286,3 +449,17 @@ void TrebleMakerEditor::updateCurve()
     // repaint only the screen area to save CPU
     repaint();
 }
+
+void TrebleMakerEditor::updateMeters(bool isLive)
+{
+    // instant attack, exponential release
+    auto ballistics = [](float& display, float target)
+    {
+        display = target > display ? target : display * 0.9f;
+    };
+    
+    ballistics(inPeakDisplay,  isLive ? dsp.inputPeak  : 0.0f);
+    ballistics(inRmsDisplay,   isLive ? dsp.inputRms   : 0.0f);
+    ballistics(outPeakDisplay, isLive ? dsp.outputPeak : 0.0f);
+    ballistics(outRmsDisplay,  isLive ? dsp.outputRms  : 0.0f);
+}
@@ -44,9 +44,31 @@ private:
     std::vector<float> eqCurve;
     float phase = 0.0f;
     
+    // latest dsp telemetry
+    DspTelemetry dsp;
+    double lastTelemetryMs = 0.0;
+    
+    // meter ballistics (linear)
+    float inPeakDisplay = 0.0f, inRmsDisplay = 0.0f;
+    float outPeakDisplay = 0.0f, outRmsDisplay = 0.0f;
+    
     void updateCurve();
+    void updateMeters(bool isLive);
     void drawScreen(juce::Graphics& g, juce::Rectangle<float> bounds);
-    void drawGrid(juce::Graphics& g, juce::Rectangle<float> bounds);
+    void drawMeters(juce::Graphics& g, juce::Rectangle<float> bounds);
+    
+    // static layers (background, grid, screen bezel, knob faces), rendered off the message thread
+    juce::ThreadPool renderPool { 1 };
+    std::atomic<int> staticLayerGeneration { 0 };
+    juce::Image staticLayer;
+    float staticLayerScale = 0.0f; // physical pixel scale last seen by paint
+    static constexpr int maxStaticLayerSize = 4096; // pixels, longest side
+    
+    void renderStaticLayerAsync();
+    static juce::Rectangle<float> getScreenArea(juce::Rectangle<float> bounds);
+    static void drawStaticLayer(juce::Graphics& g, juce::Rectangle<float> bounds);
+    static void drawScreenBackground(juce::Graphics& g, juce::Rectangle<float> bounds);
+    static void drawGrid(juce::Graphics& g, juce::Rectangle<float> bounds);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TrebleMakerEditor)
 };